@@ -43,9 +43,11 @@ _____________________________________________________________________________*/
 #include <string_view>             // Improve performance on mmap of file
 #include <iostream>                // sync_with_stdio (mix printf with cout)
 #include <sstream>                 // string_stream
+#include <fstream>                 // --frequency sample
 #include <iomanip>                 // setw and other cout formatting
 #include <thread>
 #include <mutex>
+#include <memory>                  // unique_ptr
 #include <regex>
 
 //..............................................................................
@@ -61,13 +63,33 @@ _____________________________________________________________________________*/
 #include "gg_version.h"            // s_version and s_synopsis
 #include "gg_utility.h"            // tokenize
 #include "gg_tqueue.h"             // filename distribution to threads
+#include "gg_dirent.h"             // getdents64 directory reader
 #include "gg_state.h"              // Mechanism for finite state machine
+#include "gg_cache.h"              // compiled queries on disk
 #include "gg.h"                    // declarations
 
 //..............................................................................
 #include "gg_variant.h"            // variant implementations
 
-static std::mutex open_mtx;
+namespace
+{
+	/// Per-thread path arena: full paths are built here only when needed.
+	thread_local std::string t_path;
+	thread_local std::string t_scratch;
+
+	/// Per-thread list of (arena offset, is directory) while reading a dir.
+	thread_local std::vector<std::pair<size_t, bool>> t_found;
+
+	//--------------------------------------------------------------------------
+	/// @brief materialize the full path of a_name into the per-thread arena
+	const char*
+	label (const Lettvin::Directory* a_dir, const char* a_name)
+	{
+		if (!a_dir) return a_name;
+		a_dir->path (t_path, a_name);
+		return t_path.c_str ();
+	}
+}
 
 //AAAAAAAAAAAAAAAAAAAAAAAAAAAAAAAAAAAAAAAAAAAAAAAAAAAAAAAAAAAAAAAAAAAAAAAAAAAAAA
 
@@ -136,15 +158,32 @@ operator ()()
 		syntax ("specify at least one accept or reject str");
 	}
 
-	// Compile and check for collisions between accept and reject lists
-	compile ();
+	//< s_noreject optimizes inner loop
+	s_noreject = s_reject.size () < 2;
+
+	// A query compiled before is mapped from shared memory (--shared)
+	// or from the cache (see gg_cache.h).
+	QueryCache  cache (s_querycache ? s_cachedir : string ());
+	SharedQuery shared{time_t (s_lease)};
+	bool ready{s_lease && shared.attach (*this)};
+	if (!ready && s_querycache) ready = cache.load (*this);
+	if (!ready)
+	{
+		// Compile and check for collisions between accept and reject lists
+		compile ();
 
-	// Initialize firsts to enable buffer skipping
-	debugf (1, "FIRSTS B: '%s'\n", s_firsts.c_str ());
-	sort (s_firsts.begin (), s_firsts.end ());
-	auto last = unique (s_firsts.begin (), s_firsts.end ());
-	s_firsts.erase (last, s_firsts.end ());
-	debugf (1, "FIRSTS A: '%s'\n", s_firsts.c_str ());
+		// Initialize firsts to enable buffer skipping
+		debugf (1, "FIRSTS B: '%s'\n", s_firsts.c_str ());
+		sort (s_firsts.begin (), s_firsts.end ());
+		auto last = unique (s_firsts.begin (), s_firsts.end ());
+		s_firsts.erase (last, s_firsts.end ());
+		debugf (1, "FIRSTS A: '%s'\n", s_firsts.c_str ());
+
+		// Complete the tables for single-pass search
+		seal ();
+		if (s_querycache) cache.store (*this);
+	}
+	if (s_lease && !shared.held ()) shared.publish (*this);
 
 	// Visually inspect planes
 	if (s_debug)
@@ -215,11 +254,103 @@ option (string_view a_str)
 
 	debugf (1, "OPTION: preparse: '%s'\n", a_str.data ());
 
+	if (a_str.substr (0, 8) == "--pread=")
+	{
+		s_pread = size_t (atol (a_str.data () + 8));
+		debugf (1, "PREAD BELOW (%zu)\n", s_pread);
+		return true;
+	}
+
+	if (a_str.substr (0, 8) == "--chunk=")
+	{
+		// Chunks begin on page boundaries so MADV_WILLNEED may apply.
+		size_t chunk{size_t (atol (a_str.data () + 8))};
+		s_chunk = max (size_t (4096), (chunk + 4095) & ~size_t (4095));
+		debugf (1, "CHUNK (%zu)\n", s_chunk);
+		return true;
+	}
+
+	if (a_str.substr (0, 10) == "--streams=")
+	{
+		// 1 (skipping, the default), 2, 4, or 8 interleaved DFA streams
+		s_streams = max (size_t (1), size_t (atol (a_str.data () + 10)));
+		debugf (1, "STREAMS (%zu)\n", s_streams);
+		return true;
+	}
+
+	if (a_str.substr (0, 8) == "--shift=")
+	{
+		// total bytes of strings below which Shift-And replaces the planes
+		s_shift = size_t (atol (a_str.data () + 8));
+		debugf (1, "SHIFT (%zu)\n", s_shift);
+		return true;
+	}
+
+	if (a_str.substr (0, 9) == "--manber=")
+	{
+		// strings (all of 4 or more bytes) from which Wu-Manber is used
+		s_manber = size_t (atol (a_str.data () + 9));
+		debugf (1, "MANBER (%zu)\n", s_manber);
+		return true;
+	}
+
+	if (a_str.substr (0, 9) == "--budget=")
+	{
+		// bytes of dense planes beyond which a double-array trie is used
+		s_budget = size_t (atol (a_str.data () + 9));
+		debugf (1, "BUDGET (%zu)\n", s_budget);
+		return true;
+	}
+
+	if (a_str.substr (0, 7) == "--huge=")
+	{
+		// table bytes from which planes are advised onto 2MiB pages
+		s_huge = size_t (atol (a_str.data () + 7));
+		debugf (1, "HUGE (%zu)\n", s_huge);
+		return true;
+	}
+
+	if (a_str.substr (0, 14) == "--query-cache=")
+	{
+		// directory of compiled queries (default $GG_CACHE or ~/.cache/gg)
+		s_cachedir = string (a_str.substr (14));
+		debugf (1, "QUERY CACHE (%s)\n", s_cachedir.c_str ());
+		return true;
+	}
+
+	if (a_str.substr (0, 9) == "--shared=")
+	{
+		// publish or attach the table in shared memory, leased this long
+		s_lease = size_t (atol (a_str.data () + 9));
+		debugf (1, "SHARED LEASE (%zu)\n", s_lease);
+		return true;
+	}
+
+	if (a_str.substr (0, 12) == "--frequency=")
+	{
+		// Sample (up to 64MiB of) a corpus to choose rare anchor bytes.
+		string name{a_str.substr (12)};
+		ifstream file (name, ios::binary);
+		string sample (size_t (1) << 26, '\0');
+		file.read (&sample[0], sample.size ());
+		if (!file.gcount ())
+		{
+			syntax ("--frequency file '%s' is unreadable", name.c_str ());
+		}
+		Anchors::sample (sample.data (), size_t (file.gcount ()));
+		debugf (1, "FREQUENCY from %s\n", name.c_str ());
+		return true;
+	}
+
 	bool l_nibbles{false};
+	bool l_sparse {false};
 
 	if      (a_str == "--case"     || (opt && letter == 'c')) s_caseless = false;
 	else if (a_str == "--debug"    || (opt && letter == 'd')) s_debug   += 1;
 	else if (a_str == "--nibbles"  || (opt && letter == 'n')) l_nibbles  = true;
+	else if (a_str == "--sparse"  ) l_sparse   = true;
+	else if (a_str == "--no-query-cache") s_querycache = false;
+	else if (a_str == "--shared"  ) s_lease    = 3600;
 	else if (a_str == "--quicktree"|| (opt && letter == 'q')) s_quicktree= true;
 	else if (a_str == "--suppress" || (opt && letter == 's')) s_suppress = true;
 	else if (a_str == "--test"     || (opt && letter == 't')) s_test     = true;
@@ -253,18 +384,29 @@ option (string_view a_str)
 	{
 		return false;
 	}
+	if ((l_nibbles && s_shape.sparse ()) || (l_sparse && nbls))
+	{
+		syntax ("choose one of --nibbles and --sparse");
+	}
 	if (l_nibbles && !nbls)
 	{
 		/// This is where command-line option -n causes plane size to change.
 		s_shape (true);
 	}
+	if (l_sparse && !s_shape.sparse ())
+	{
+		s_shape (false, true);
+	}
 	return true;
 }
 
 //------------------------------------------------------------------------------
-/// @brief ingest inserts state-transition table data
-//
-// For now, gg fails when GG_COMPILE is defined
+/// @brief ingest records options and pattern strings for the ftor
+///
+/// Each argument is held back in s_target until the next arrives, since
+/// the last is the target.  s_target is then overwritten, so a pattern
+/// is copied into m_patterns (which never moves its strings) for
+/// s_accept and s_reject to view.
 void
 Lettvin::GreasedGrep::
 ingest (string_view a_str)
@@ -293,18 +435,14 @@ ingest (string_view a_str)
 		{
 			syntax ("pattern strings must be longer than 1 byte");
 		}
-		field.push_back (candidate);
-#ifndef GG_COMPILE
-		// This compile passes
-		i24_t sign            {rejecting?-1:+1};
-		compile (sign, candidate);
-#endif
+		m_patterns.emplace_back (candidate);
+		field.push_back (m_patterns.back ());
 	}
 	s_target = a_str;
 } // ingest
 
 //------------------------------------------------------------------------------
-/// @brief ingest inserts state-transition table data
+/// @brief compile inserts state-transition table data
 void
 Lettvin::GreasedGrep::
 compile (int32_t a_sign)
@@ -320,20 +458,11 @@ compile (int32_t a_sign)
 	auto& field    {rejecting ? s_reject : s_accept};
 	size_t I       {field.size ()};
 
-	//< s_noreject optimizes inner loop
-	if (rejecting && I > 1)
-	{
-		s_noreject = false;
-	}
-
-#ifdef GG_COMPILE
-		// This compile fails
 	for (size_t i = 1; i < I; ++i)
 	{
-		compile (a_sign, field[i]);
+		compile (a_sign * static_cast<i24_t> (i), field[i]);
 	}
-#endif
-}
+} // compile
 
 //------------------------------------------------------------------------------
 /// @brief compile a single string argument
@@ -341,16 +470,14 @@ compile (int32_t a_sign)
 /// Distribute characters into state tables for searching.
 void
 Lettvin::GreasedGrep::
-compile (int32_t a_sign, string_view a_sv)
+compile (i24_t a_id, string_view a_sv)
 //------------------------------------------------------------------------------
 {
-	debugf (1, "COMPILE %+d: %s\n", a_sign, a_sv.data ());
-	bool rejecting   {a_sign == -1};
+	debugf (1, "COMPILE %+d: %.*s\n", a_id, int (a_sv.size ()), a_sv.data ());
 	auto from        {s_root};
 	auto next        {from};
 	char last[2]     {0,0};
-	auto& field      {rejecting ? s_reject : s_accept};
-	i24_t id         {a_sign*static_cast<i24_t> (field.size () - 1)};
+	i24_t id         {a_id};
 	string b_str     {};
 	string a_str     {a_sv};
 
@@ -431,103 +558,245 @@ compile (int32_t a_sign, string_view a_sv)
 /// https://techoverflow.net/2013/08/21/a-simple-mmap-readonly-example/
 void
 Lettvin::GreasedGrep::
-mapped_search (const char* a_filename)
+mapped_search (Directory* a_dir, const char* a_name)
 //------------------------------------------------------------------------------
 {
-	struct stat st;
-	stat (a_filename, &st);
-	auto filesize{st.st_size};
-	if (!filesize)
-	{
-		return; // Can't search an empty file
-	}
 	int32_t fd{0};
 	int err{0};
-
-	if (s_quicktree)
+	const char* name{a_name};
+	int32_t at{a_dir ? a_dir->at (name, t_scratch) : AT_FDCWD};
+	auto done = [this, a_dir] (int32_t a_fd)
 	{
-		printf ("gg:quicktree (%s)\n", a_filename);
-		return;
-	}
+		if (a_fd >= 0) close (a_fd);
+		m_fds.release ();
+		if (a_dir) a_dir->release ();
+	};
 
 	if (s_regex.size ())
 	{
 		TODO(return if filename pattern does not match a filesx)
 		bool matched{false};
+		const char* filename{label (a_dir, a_name)};
 		for (auto& matcher:s_regex)
 		{
-			matched |= regex_search (a_filename, matcher);
+			matched |= regex_search (filename, matcher);
 		}
 		if (!matched)
 		{
+			if (a_dir) a_dir->release ();
 			return;
 		}
 	}
 
-	try
+	// No lock: errno is per-thread and captured immediately after each call.
+	// The descriptor budget replaces EMFILE (24) failures with waiting.
+	m_fds.acquire ();
+	fd = openat (at, name, O_RDONLY | O_CLOEXEC, 0);
+	err = errno;
+
+	// Only regular files arrive here so fstat is needed just for the size.
+	struct stat st;
+	if (fd >= 0 && (fstat (fd, &st) || !st.st_size))
 	{
-		std::unique_lock<std::mutex> lck (open_mtx, std::defer_lock);
-		lck.lock ();
-		errno = 0;
-		fd = open (a_filename, O_RDONLY, 0);
-		err = errno;
-		lck.unlock ();
+		done (fd);
+		return; // Can't search an empty file
 	}
-	catch (...)
+
+	if (fd >= 0 && s_quicktree)
 	{
-		if (fd > 0) close (fd);
-		if (!s_suppress)
+		printf ("gg:quicktree (%s)\n", label (a_dir, a_name));
+		done (fd);
+		return;
+	}
+
+	// Small files: a single pread into a pooled buffer costs less
+	// than mmap page-table setup.  The descriptor is closed at once
+	// and the buffer is searched by a scan worker, so I/O workers
+	// (s_oversize per core) never compete with scanners for cores.
+	// Should no buffer be allocated, the file is mapped instead.
+	size_t filesize{fd >= 0 ? size_t (st.st_size) : 0};
+	char* buffer{nullptr};
+	if (fd >= 0 && filesize < s_pread && !m_buffers.try_pop (buffer))
+	{
+		size_t bytes{(s_pread + 4095) & ~size_t (4095)};
+		buffer = static_cast<char*> (aligned_alloc (4096, bytes));
+	}
+	if (buffer)
+	{
+		size_t got{0};
+		ssize_t n{0};
+		while (got < filesize &&
+				(n = pread (fd, buffer + got, filesize - got, got)) > 0)
 		{
-			printf ("gg:mapped_search OPEN EXCEPTION: %s\n", a_filename);
+			got += size_t (n);
 		}
+		err = errno;
+		close (fd);
+		m_fds.release ();
+		if (n < 0 || !got)
+		{
+			if (n < 0 && !s_suppress)
+			{
+				printf ("gg:mapped_search READ FAILED(%d): %s\n",
+						err,
+						label (a_dir, a_name));
+			}
+			if (!m_buffers.try_push (move (buffer))) free (buffer);
+			if (a_dir) a_dir->release ();
+			return;
+		}
+		// The scan worker owns the buffer and the reference.
+		m_mapped.push (Mapped{a_dir, a_name, buffer, got, -1, {}, true});
 		return;
 	}
 
 	if (fd >= 0)
 	{
-		std::unique_lock<std::mutex> lck (open_mtx, std::defer_lock);
-		lck.lock ();
-		errno = 0;
+		// Large files: no MAP_POPULATE, which would fault in the whole
+		// file even when search rejects early.  The kernel reads ahead
+		// sequentially and search advises MADV_WILLNEED window by window.
 		void* contents = mmap (
 				NULL,
 				filesize,
 				PROT_READ,					// Optimize out dirty pages
-				MAP_PRIVATE | MAP_POPULATE,	// Allow preload
+				MAP_PRIVATE,
 				fd,
 				0);
 		err = errno;
-		lck.unlock ();
+		if (contents != MAP_FAILED)
+		{
+			madvise (contents, filesize, MADV_SEQUENTIAL);
+		}
 
 		if (contents == MAP_FAILED)
 		{
-			if (err == ENODEV)
-			{
-				if (fd > 0) close (fd);
-				return;  // TODO discover why this ever occurs.
-			}
 			if (!s_suppress)
 			{
 				printf ("gg:mapped_search MAP FAILED(%d): %s\n",
 						err,
-						a_filename);
+						label (a_dir, a_name));
 			}
 		}
 		else
 		{
-			track (contents, filesize, a_filename);
-			int32_t rc = munmap (contents, filesize);
-			if (rc != 0) synopsis ("munmap failed");
+			// The scan worker owns the mapping, descriptor and reference.
+			m_mapped.push (Mapped{a_dir, a_name, contents, filesize, fd});
+			return;
 		}
-
-		close (fd);
 	}
 	else if (!s_suppress)
 	{
-		// TODO eliminate EMFILE (24)
-		printf ("gg:mapped_search OPEN FAILED(%d): %s\n", err, a_filename);
+		printf ("gg:mapped_search OPEN FAILED(%d): %s\n",
+				err,
+				label (a_dir, a_name));
 	}
+	done (fd);
 } // mapped_search
 
+//------------------------------------------------------------------------------
+/// @brief scan worker: search mapped files until the sentinel arrives
+void
+Lettvin::GreasedGrep::
+scan ()
+//------------------------------------------------------------------------------
+{
+	Mapped mapped;
+	while ((m_mapped.pop (mapped), mapped.m_name || mapped.m_job))
+	{
+		if (mapped.m_job)
+		{
+			chunks (*mapped.m_job);
+			continue;
+		}
+		if (scan (mapped))
+		{
+			// Paths are materialized only for matching files.
+			report (label (mapped.m_dir, mapped.m_name));
+		}
+		if (mapped.m_read)
+		{
+			char* buffer{static_cast<char*> (mapped.m_contents)};
+			if (!m_buffers.try_push (move (buffer))) free (buffer);
+		}
+		else
+		{
+			int32_t rc = munmap (mapped.m_contents, mapped.m_size);
+			if (rc != 0) synopsis ("munmap failed");
+			close (mapped.m_fd);
+			m_fds.release ();
+		}
+		if (mapped.m_dir) mapped.m_dir->release ();
+	}
+} // scan
+
+//------------------------------------------------------------------------------
+/// @brief search a mapped file, in parallel chunks when large
+///
+/// Files of at least two s_chunk are split.  Idle scan workers are invited
+/// to help through the queue; the owner claims chunks too, so the file is
+/// finished even if no helper arrives.
+bool
+Lettvin::GreasedGrep::
+scan (const Mapped& a_mapped)
+//------------------------------------------------------------------------------
+{
+	if (a_mapped.m_size < 2 * s_chunk)
+	{
+		return search (a_mapped.m_contents, a_mapped.m_size, !a_mapped.m_read);
+	}
+
+	auto job{make_shared<Job> ()};
+	job->m_base    = static_cast<const char*> (a_mapped.m_contents);
+	job->m_size    = a_mapped.m_size;
+	job->m_chunk   = s_chunk;
+	job->m_overlap = longest ();
+	job->m_chunks  = (a_mapped.m_size + s_chunk - 1) / s_chunk;
+	for (size_t i=1; i < min (job->m_chunks, m_scanners); ++i)
+	{
+		if (!m_mapped.try_push (Mapped{
+					nullptr, nullptr, nullptr, 0, -1, job})) break;
+	}
+	chunks (*job);
+	while (job->m_finished.load (std::memory_order_acquire) < job->m_chunks)
+	{
+		this_thread::yield ();
+	}
+	return verdict (job->m_tally);
+} // scan
+
+//------------------------------------------------------------------------------
+/// @brief claim and scan chunks of a_job until none remain
+void
+Lettvin::GreasedGrep::
+chunks (Job& a_job)
+//------------------------------------------------------------------------------
+{
+	size_t chunk;
+	while ((chunk = a_job.m_next.fetch_add (1)) < a_job.m_chunks)
+	{
+		thread_local Tally tally;
+		tally.reset ();
+		size_t begin{chunk * a_job.m_chunk};
+		size_t anchors{min (a_job.m_chunk, a_job.m_size - begin)};
+		size_t count{min (anchors + a_job.m_overlap, a_job.m_size - begin)};
+		if (!a_job.m_cancel.load (std::memory_order_relaxed))
+		{
+			Table::scan (a_job.m_base + begin, anchors, count,
+					tally, &a_job.m_cancel, true);
+		}
+		{
+			lock_guard<mutex> lck (a_job.m_mutex);
+			a_job.m_tally.merge (tally);
+			bool full{a_job.m_tally.accepts () == s_accept.size ()};
+			if (a_job.m_tally.m_rejected || (s_noreject && full))
+			{
+				a_job.m_cancel = true;
+			}
+		}
+		a_job.m_finished.fetch_add (1, std::memory_order_release);
+	}
+} // chunks
+
 //------------------------------------------------------------------------------
 /// @brief run search on incoming packets
 void
@@ -539,43 +808,115 @@ netsearch (string_view a_URL)
 
 //------------------------------------------------------------------------------
 /// @brief walk organizes search for strings in memory-mapped file
+///
+/// 1 manager (this thread), N*oversize I/O workers and N scan workers
+/// where N=cpu count and oversize is the -1 ... -9 option.
+/// I/O workers share the tree through per-worker deques with stealing,
+/// then open and map files for the scan workers.
+/// Many I/O workers keep opens in flight on high-latency mounts (sshfs)
+/// without oversubscribing the cores which scan.
 void
 Lettvin::GreasedGrep::
 walk (const string& a_path)
 {
-	// Don't attempt to assess validity of filenames... just fail.
-	// Treat directories like files and search filenames in directories.
-	// This enables gg to work on sshfs mounted filesystems.
-	auto d{a_path};
-	auto s{d.size ()};
-	if (s && d[s - 1] == '/') d.resize (s-1);
-	errno = 0;
-    if (auto dir = opendir (d.c_str ()))
-	{
-		while (!errno)
+	size_t cpus{thread::hardware_concurrency ()};
+	size_t scanners{cpus ? cpus : 1};
+	size_t workers{scanners * s_oversize};
+	debugf (1, "POOL: %zu I/O workers, %zu scan workers\n", workers, scanners);
+
+	// Each I/O worker may also hold one directory stream open.
+	m_fds.reserve (64 + workers);
+	debugf (1, "FDS: budget of %zu descriptors\n", m_fds.limit ());
+
+	m_scanners = scanners;
+	vector<thread> threads;
+	for (size_t i=0; i < scanners; ++i)
+	{
+		threads.emplace_back (thread{[this] () { scan (); }});
+	}
+
+	// Directories are expanded, regular files searched, all else ignored.
+	// Trailing slashes are dropped ("dir//" is "dir") but a lone "/" stays.
+	string root{a_path};
+	size_t s{root.find_last_not_of ('/')};
+	root.resize (s == string::npos ? min (root.size (), size_t (1)) : s + 1);
+	uint8_t type{DirReader::classify (AT_FDCWD, root.c_str (), DT_UNKNOWN)};
+	if (type == DT_DIR || type == DT_REG)
+	{
+		WorkStealing<Entry> pool (workers);
+		pool (Entry{nullptr, root.c_str (), type == DT_DIR}, [this, &pool] (
+					size_t a_worker, Entry& a_entry)
 		{
-			if (auto f = readdir (dir))
-			{
-				if (auto p = f->d_name)
-				{
-					if (auto q = p)
-					{
-						if (!(*q++ == '.' && (!*q || (*q++ == '.' && !*q))))
-						{
-							auto e = d + "/" + p;
-							walk (e);
-							mapped_search (e.c_str ());
-							errno = 0;
-						}
-					}
-					else break;
-				}
-				else break;
-			}
-			else break;
+			walk (pool, a_worker, a_entry);
+		});
+	}
+
+	// cleanup: terminate scan workers with empty name sentinels
+	for (size_t i=0; i < scanners; ++i)
+	{
+		m_mapped.push (Mapped{});
+	}
+	for (auto& thrd:threads) thrd.join ();
+	char* buffer;
+	while (m_buffers.try_pop (buffer)) free (buffer);
+} // walk
+
+//------------------------------------------------------------------------------
+/// @brief walk one entry: expand a directory into tasks or search a file
+///
+/// DirReader classifies entries by d_type, so directories are never
+/// opened for content search and files are never opened as directories.
+/// Children are opened relative to the retained parent Directory.
+void
+Lettvin::GreasedGrep::
+walk (WorkStealing<Entry>& a_pool, size_t a_worker, Entry& a_entry)
+{
+	Directory* parent{a_entry.m_dir};
+	if (!a_entry.m_directory)
+	{
+		mapped_search (parent, a_entry.m_name);
+		return;
+	}
+
+	const char* name{a_entry.m_name};
+	int32_t at{parent ? parent->at (name, t_scratch) : AT_FDCWD};
+	DirReader reader (name, at);
+	if (!reader.is_open ())
+	{
+		if (!s_suppress)
+		{
+			printf ("gg:walk OPEN FAILED(%d): %s\n",
+					reader.error (),
+					label (parent, a_entry.m_name));
 		}
+		if (parent) parent->release ();
+		return;
 	}
-}
+
+	// Fill the arena completely before handing out names from it.
+	auto directory{new Directory (parent, a_entry.m_name)};
+	if (parent) parent->release ();
+	auto& found{t_found};
+	found.clear ();
+	const char* entry{nullptr};
+	uint8_t type{DT_UNKNOWN};
+	while (reader.next (entry, type))
+	{
+		if (type == DT_DIR || type == DT_REG)
+		{
+			found.emplace_back (directory->add (entry), type == DT_DIR);
+		}
+	}
+	directory->adopt (reader.detach (), m_fds);
+
+	for (auto& [offset, is_directory]:found)
+	{
+		directory->retain ();
+		a_pool.push (a_worker,
+				Entry{directory, directory->name (offset), is_directory});
+	}
+	directory->release ();
+} // walk
 
 //------------------------------------------------------------------------------
 void
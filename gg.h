@@ -58,9 +58,13 @@ _____________________________________________________________________________*/
 //..............................................................................
 #include <string>                  // container
 #include <vector>                  // container
+#include <memory>                  // shared_ptr
+#include <atomic>                  // chunk claiming and cancellation
+#include <mutex>                   // chunk tally merging
 #include <chrono>                  // steady_clock
 #include <map>                     // container
 #include <set>                     // container
+#include <deque>                   // stable pattern storage
 
 //..............................................................................
 #include "catch.hpp"               // Testing framework
@@ -68,6 +72,8 @@ _____________________________________________________________________________*/
 //..............................................................................
 #include "gg_globals.h"
 #include "gg_utility.h"            // Finite State Machine
+#include "gg_tqueue.h"             // Work distribution to threads
+#include "gg_dirent.h"             // getdents64 directory reader
 #include "gg_state.h"              // Finite State Machine
 #include "gg_version.h"            // version
 
@@ -103,6 +109,58 @@ namespace Lettvin
 		return seconds;
 	}
 
+	//__________________________________________________________________________
+	/// @brief chunks of one large mapped file shared among scan workers
+	///
+	/// Chunk i anchors in [i*m_chunk, (i+1)*m_chunk) and may read m_overlap
+	/// (longest string) bytes beyond, so no match straddling a boundary is
+	/// lost.  Chunk tallies merge into m_tally; a reject (or completion
+	/// when there are no reject strings) sets m_cancel for the siblings.
+	struct Job
+	{
+		const char*    m_base    {nullptr};
+		size_t         m_size    {0};
+		size_t         m_chunk   {0};
+		size_t         m_overlap {0};
+		size_t         m_chunks  {0};
+		atomic<size_t> m_next    {0};       ///< next chunk to claim
+		atomic<size_t> m_finished{0};       ///< chunks merged
+		atomic<bool>   m_cancel  {false};
+		mutex          m_mutex;             ///< guards m_tally
+		Tally          m_tally;
+	};
+
+	//__________________________________________________________________________
+	/// @brief a file opened and mapped by an I/O worker for a scan worker
+	///
+	/// Holds the Entry's reference on m_dir until the scan is complete.
+	/// When m_read, m_contents is a pread buffer from m_buffers and m_fd
+	/// is already closed.
+	/// A non-null m_job asks an idle scan worker to help with its chunks.
+	/// A null m_name and m_job is the sentinel which terminates a scan worker.
+	struct Mapped
+	{
+		Directory*      m_dir     {nullptr};
+		const char*     m_name    {nullptr};
+		void*           m_contents{nullptr};
+		size_t          m_size    {0};
+		int32_t         m_fd      {-1};
+		shared_ptr<Job> m_job     {};
+		bool            m_read    {false};
+	};
+
+	//__________________________________________________________________________
+	/// @brief a name found by an I/O worker and classified by DirReader
+	///
+	/// m_name lives in m_dir's arena and m_dir is retained for the Entry.
+	/// The root Entry has a null m_dir and m_name is the target path.
+	struct Entry
+	{
+		Directory*  m_dir      {nullptr};
+		const char* m_name     {nullptr};
+		bool        m_directory{false};
+	};
+
 	//CCCCCCCCCCCCCCCCCCCCCCCCCCCCCCCCCCCCCCCCCCCCCCCCCCCCCCCCCCCCCCCCCCCCCCCCCC
 	//__________________________________________________________________________
 	/// @brief GreasedGrep implements overall state-transition operations
@@ -145,28 +203,52 @@ namespace Lettvin
 		/// @brief compile a single string argument
 		///
 		/// Distribute characters into state tables for searching.
-		void compile (int32_t a_sign, string_view a_str);
+		/// a_id is the string's index in s_accept, or minus its s_reject index.
+		void compile (i24_t a_id, string_view a_str);
 
 		//----------------------------------------------------------------------
 		/// @brief run search on incoming packets
 		void netsearch (string_view a_URL);
 
 		//----------------------------------------------------------------------
-		/// @brief map file into memory and call search
+		/// @brief read small or map large file into memory and call search
 		///
+		/// Files smaller than s_pread are read into a pooled buffer and
+		/// larger files are mapped; both are queued for the scan workers.
 		/// https://techoverflow.net/2013/08/21/a-simple-mmap-readonly-example/
-		void mapped_search (const char* a_filename);
+		/// Consumes the Entry's reference on a_dir.
+		void mapped_search (Directory* a_dir, const char* a_name);
+
+		//----------------------------------------------------------------------
+		/// @brief scan worker: search mapped files until the sentinel arrives
+		void scan ();
+
+		//----------------------------------------------------------------------
+		/// @brief search a mapped file, in parallel chunks when large
+		bool scan (const Mapped& a_mapped);
+
+		//----------------------------------------------------------------------
+		/// @brief claim and scan chunks of a_job until none remain
+		void chunks (Job& a_job);
 
 		//----------------------------------------------------------------------
 		/// @brief walk organizes search for strings in memory-mapped file
 		void walk (const string& a_path);
 
-		bool is_directory    (const string& a_path);
-		bool is_regular_file (const string& a_path);
+		//----------------------------------------------------------------------
+		/// @brief walk one entry as a task of the work-stealing pool
+		void walk (WorkStealing<Entry>& a_pool, size_t a_worker, Entry& a_entry);
 
 		//----------------------------------------------------------------------
 		void show_tokens (ostream& a_os);
 
+		//dddddddddddddddddddddddddddddddddddddddddddddddddddddddddddddddddddddd
+		ThreadedQueue<Mapped> m_mapped{256}; ///< I/O workers to scan workers
+		ThreadedQueue<char*>  m_buffers{256};///< idle s_pread buffers
+		size_t                m_scanners{1}; ///< count of scan workers
+		FdBudget              m_fds;         ///< open descriptors permitted
+		deque<string>         m_patterns;    ///< text viewed by s_accept/s_reject
+
 	}; // class GreasedGrep
 
 } // namespace Lettvin
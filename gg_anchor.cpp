@@ -0,0 +1,543 @@
+/*_____________________________________________________________________________
+            The MIT License (https://opensource.org/licenses/MIT)
+
+        Copyright (c) 2017, Jonathan D. Lettvin, All Rights Reserved.
+
+Permission is hereby granted, free of charge, to any person obtaining a copy of
+this software and associated documentation files (the "Software"), to deal in
+the Software without restriction, including without limitation the rights to
+use, copy, modify, merge, publish, distribute, sublicense, and/or sell copies
+of the Software, and to permit persons to whom the Software is furnished to do
+so, subject to the following conditions:
+
+The above copyright notice and this permission notice shall be included in all
+copies or substantial portions of the Software.
+
+THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+SOFTWARE.
+_____________________________________________________________________________*/
+
+#include <cstring>                 // memchr
+
+#if defined (__x86_64__) || defined (__i386__)
+#include <immintrin.h>
+#define GG_X86 1
+#else
+#define GG_X86 0
+#endif
+
+#include "gg_anchor.h"
+
+//------------------------------------------------------------------------------
+/// @brief human-readable kernel name for debug and benchmarks
+const char*
+Lettvin::Anchors::
+name (Kernel a_kernel)
+//------------------------------------------------------------------------------
+{
+	switch (a_kernel)
+	{
+		case NONE:         return "none";
+		case MEMCHR:       return "memchr";
+		case SCALAR:       return "scalar";
+		case EQUAL_SSE2:   return "equal/sse2";
+		case EQUAL_AVX2:   return "equal/avx2";
+		case SHUFTI_SSSE3: return "shufti/ssse3";
+		case SHUFTI_AVX2:  return "shufti/avx2";
+		case AUTOMATIC:    return "automatic";
+	}
+	return "unknown";
+} // name
+
+//------------------------------------------------------------------------------
+/// @brief can this CPU run a_kernel
+bool
+Lettvin::Anchors::
+supported (Kernel a_kernel)
+//------------------------------------------------------------------------------
+{
+	switch (a_kernel)
+	{
+#if GG_X86
+		case EQUAL_SSE2:   return __builtin_cpu_supports ("sse2");
+		case SHUFTI_SSSE3: return __builtin_cpu_supports ("ssse3");
+		case EQUAL_AVX2:
+		case SHUFTI_AVX2:  return __builtin_cpu_supports ("avx2");
+#else
+		case EQUAL_SSE2:
+		case SHUFTI_SSSE3:
+		case EQUAL_AVX2:
+		case SHUFTI_AVX2:  return false;
+#endif
+		default:           return true;
+	}
+} // supported
+
+//------------------------------------------------------------------------------
+/// @brief compare a_size bytes of a_text with a (lower case) literal
+bool
+Lettvin::Anchors::
+equal (const char* a_text, const char* a_literal, size_t a_size, bool a_caseless)
+//------------------------------------------------------------------------------
+{
+	if (!a_caseless) return !memcmp (a_text, a_literal, a_size);
+	size_t offset{0};
+#if GG_X86
+	__m128i below{_mm_set1_epi8 ('A' - 1)};
+	__m128i above{_mm_set1_epi8 ('Z' + 1)};
+	__m128i fold {_mm_set1_epi8 (0x20)};
+	for (; offset + 16 <= a_size; offset += 16)
+	{
+		__m128i v{_mm_loadu_si128 ((const __m128i*)(a_text + offset))};
+		__m128i l{_mm_loadu_si128 ((const __m128i*)(a_literal + offset))};
+		__m128i upper{_mm_and_si128 (
+				_mm_cmpgt_epi8 (v, below), _mm_cmpgt_epi8 (above, v))};
+		v = _mm_or_si128 (v, _mm_and_si128 (upper, fold));
+		if (_mm_movemask_epi8 (_mm_cmpeq_epi8 (v, l)) != 0xffff) return false;
+	}
+#endif
+	for (; offset < a_size; ++offset)
+	{
+		char c{a_text[offset]};
+		if (c >= 'A' && c <= 'Z') c |= 0x20;
+		if (c != a_literal[offset]) return false;
+	}
+	return true;
+} // equal
+
+//------------------------------------------------------------------------------
+/// @brief replace s_frequency with byte counts of a sample corpus
+///
+/// Counts are scaled to bytes per million; absent bytes count 1 so that
+/// every byte keeps a non-zero cost.
+void
+Lettvin::Anchors::
+sample (const char* a_data, size_t a_size)
+//------------------------------------------------------------------------------
+{
+	if (!a_size) return;
+	array<size_t, 256> counts{};
+	for (size_t offset=0; offset < a_size; ++offset)
+	{
+		++counts[static_cast<uint8_t> (a_data[offset])];
+	}
+	for (size_t byte=0; byte < 256; ++byte)
+	{
+		double permillion{1e6 * counts[byte] / a_size};
+		s_frequency[byte] = max (uint32_t (1), uint32_t (permillion + 0.5));
+	}
+} // sample
+
+//------------------------------------------------------------------------------
+/// @brief build tables for a_set and choose a kernel
+void
+Lettvin::Anchors::
+assign (string_view a_set, Kernel a_kernel)
+//------------------------------------------------------------------------------
+{
+	memset (m_lo, 0, sizeof (m_lo));
+	memset (m_hi, 0, sizeof (m_hi));
+	memset (m_member, 0, sizeof (m_member));
+	m_count = 0;
+
+	// Bucket by high nibble: exact for up to 8 distinct high nibbles.
+	int8_t bucket[16];
+	memset (bucket, -1, sizeof (bucket));
+	size_t buckets{0};
+	for (char c:a_set)
+	{
+		uint8_t byte{static_cast<uint8_t> (c)};
+		if (m_member[byte]) continue;
+		m_member[byte] = true;
+		if (m_count < sizeof (m_bytes)) m_bytes[m_count] = byte;
+		++m_count;
+		uint8_t hi{static_cast<uint8_t> (byte >> 4)};
+		if (bucket[hi] < 0) bucket[hi] = static_cast<int8_t> (buckets++ % 8);
+		uint8_t bit{static_cast<uint8_t> (1 << bucket[hi])};
+		m_lo[byte & 0xf] |= bit;
+		m_hi[hi]         |= bit;
+	}
+	// Tiny-set kernels always compare with three bytes: repeat a member.
+	for (size_t i=m_count; m_count && i < sizeof (m_bytes); ++i)
+	{
+		m_bytes[i] = m_bytes[0];
+	}
+	// AVX2 PSHUFB looks up within each 128-bit lane: replicate.
+	memcpy (m_lo + 16, m_lo, 16);
+	memcpy (m_hi + 16, m_hi, 16);
+
+	if (a_kernel != AUTOMATIC)
+	{
+		m_kernel = m_count ? a_kernel : NONE;
+		return;
+	}
+	if      (m_count == 0)                                  m_kernel = NONE;
+	else if (m_count == 1)                                  m_kernel = MEMCHR;
+	else if (m_count <= 3 && supported (EQUAL_AVX2))        m_kernel = EQUAL_AVX2;
+	else if (m_count <= 3 && supported (EQUAL_SSE2))        m_kernel = EQUAL_SSE2;
+	else if (supported (SHUFTI_AVX2))                       m_kernel = SHUFTI_AVX2;
+	else if (supported (SHUFTI_SSSE3))                      m_kernel = SHUFTI_SSSE3;
+	else                                                    m_kernel = SCALAR;
+} // assign
+
+//------------------------------------------------------------------------------
+/// @brief offset in [a_from, a_count) of the first member, or npos
+size_t
+Lettvin::Anchors::
+find (const char* a_data, size_t a_from, size_t a_count) const
+//------------------------------------------------------------------------------
+{
+	if (a_from >= a_count) return npos;
+	const uint8_t* data{reinterpret_cast<const uint8_t*> (a_data)};
+	switch (m_kernel)
+	{
+		case NONE: return npos;
+		case MEMCHR:
+		{
+			auto found{memchr (data + a_from, m_bytes[0], a_count - a_from)};
+			return found ? static_cast<const uint8_t*> (found) - data : npos;
+		}
+		case EQUAL_SSE2:   return equal_sse2   (data, a_from, a_count);
+		case EQUAL_AVX2:   return equal_avx2   (data, a_from, a_count);
+		case SHUFTI_SSSE3: return shufti_ssse3 (data, a_from, a_count);
+		case SHUFTI_AVX2:  return shufti_avx2  (data, a_from, a_count);
+		default:           return scalar       (data, a_from, a_count);
+	}
+} // find
+
+//------------------------------------------------------------------------------
+/// @brief table lookup per byte (tails and CPUs without SIMD)
+size_t
+Lettvin::Anchors::
+scalar (const uint8_t* a_data, size_t a_from, size_t a_count) const
+//------------------------------------------------------------------------------
+{
+	for (size_t offset=a_from; offset < a_count; ++offset)
+	{
+		if (m_member[a_data[offset]]) return offset;
+	}
+	return npos;
+} // scalar
+
+//PPPPPPPPPPPPPPPPPPPPPPPPPPPPPPPPPPPPPPPPPPPPPPPPPPPPPPPPPPPPPPPPPPPPPPPPPPPPPP
+
+//------------------------------------------------------------------------------
+/// @brief forget all pairs
+void
+Lettvin::Pairs::
+clear ()
+//------------------------------------------------------------------------------
+{
+	memset (m_lo1, 0, sizeof (m_lo1));
+	memset (m_hi1, 0, sizeof (m_hi1));
+	memset (m_lo2, 0, sizeof (m_lo2));
+	memset (m_hi2, 0, sizeof (m_hi2));
+	memset (m_pair, 0, sizeof (m_pair));
+	memset (m_bucket, -1, sizeof (m_bucket));
+	m_buckets = 0;
+	m_count = 0;
+	m_kernel = Anchors::NONE;
+} // clear
+
+//------------------------------------------------------------------------------
+/// @brief allow strings to begin with a_first then a_second
+///
+/// A bucket holds every first byte with one high nibble (exact up to 8
+/// high nibbles) and the union of their second bytes.
+void
+Lettvin::Pairs::
+insert (uint8_t a_first, uint8_t a_second)
+//------------------------------------------------------------------------------
+{
+	if (allowed (a_first, a_second)) return;
+	size_t bit{(size_t (a_first) << 8) | a_second};
+	m_pair[bit >> 6] |= uint64_t (1) << (bit & 63);
+	++m_count;
+	uint8_t hi{static_cast<uint8_t> (a_first >> 4)};
+	if (m_bucket[hi] < 0) m_bucket[hi] = static_cast<int8_t> (m_buckets++ % 8);
+	uint8_t mask{static_cast<uint8_t> (1 << m_bucket[hi])};
+	m_lo1[a_first & 0xf]  |= mask;
+	m_hi1[hi]             |= mask;
+	m_lo2[a_second & 0xf] |= mask;
+	m_hi2[a_second >> 4]  |= mask;
+} // insert
+
+//------------------------------------------------------------------------------
+/// @brief choose a kernel after all inserts
+void
+Lettvin::Pairs::
+prepare (Anchors::Kernel a_kernel)
+//------------------------------------------------------------------------------
+{
+	// AVX2 PSHUFB looks up within each 128-bit lane: replicate.
+	memcpy (m_lo1 + 16, m_lo1, 16);
+	memcpy (m_hi1 + 16, m_hi1, 16);
+	memcpy (m_lo2 + 16, m_lo2, 16);
+	memcpy (m_hi2 + 16, m_hi2, 16);
+	if (!m_count)                                          m_kernel = Anchors::NONE;
+	else if (a_kernel != Anchors::AUTOMATIC)               m_kernel = a_kernel;
+	else if (Anchors::supported (Anchors::SHUFTI_AVX2))    m_kernel = Anchors::SHUFTI_AVX2;
+	else if (Anchors::supported (Anchors::SHUFTI_SSSE3))   m_kernel = Anchors::SHUFTI_SSSE3;
+	else                                                   m_kernel = Anchors::SCALAR;
+} // prepare
+
+//------------------------------------------------------------------------------
+/// @brief offset in [a_from, a_count - 1) of the first pair, or npos
+size_t
+Lettvin::Pairs::
+find (const char* a_data, size_t a_from, size_t a_count) const
+//------------------------------------------------------------------------------
+{
+	if (a_from + 1 >= a_count) return npos;
+	const uint8_t* data{reinterpret_cast<const uint8_t*> (a_data)};
+	switch (m_kernel)
+	{
+		case Anchors::NONE:         return npos;
+		case Anchors::SHUFTI_SSSE3: return shufti_ssse3 (data, a_from, a_count);
+		case Anchors::SHUFTI_AVX2:  return shufti_avx2  (data, a_from, a_count);
+		default:                    return scalar       (data, a_from, a_count);
+	}
+} // find
+
+//------------------------------------------------------------------------------
+/// @brief pair table lookup per offset (tails and CPUs without SIMD)
+size_t
+Lettvin::Pairs::
+scalar (const uint8_t* a_data, size_t a_from, size_t a_count) const
+//------------------------------------------------------------------------------
+{
+	for (size_t offset=a_from; offset + 1 < a_count; ++offset)
+	{
+		if (allowed (a_data[offset], a_data[offset + 1])) return offset;
+	}
+	return npos;
+} // scalar
+
+#if GG_X86
+//------------------------------------------------------------------------------
+/// @brief compare 16 bytes at a time with each of up to 3 members
+size_t
+Lettvin::Anchors::
+equal_sse2 (const uint8_t* a_data, size_t a_from, size_t a_count) const
+//------------------------------------------------------------------------------
+{
+	__m128i b0{_mm_set1_epi8 (m_bytes[0])};
+	__m128i b1{_mm_set1_epi8 (m_bytes[1])};
+	__m128i b2{_mm_set1_epi8 (m_bytes[2])};
+	size_t offset{a_from};
+	for (; offset + 16 <= a_count; offset += 16)
+	{
+		__m128i v{_mm_loadu_si128 ((const __m128i*)(a_data + offset))};
+		__m128i eq{_mm_or_si128 (
+				_mm_or_si128 (_mm_cmpeq_epi8 (v, b0), _mm_cmpeq_epi8 (v, b1)),
+				_mm_cmpeq_epi8 (v, b2))};
+		if (int mask = _mm_movemask_epi8 (eq))
+		{
+			return offset + __builtin_ctz (mask);
+		}
+	}
+	return scalar (a_data, offset, a_count);
+} // equal_sse2
+
+//------------------------------------------------------------------------------
+/// @brief compare 32 bytes at a time with each of up to 3 members
+__attribute__ ((target ("avx2")))
+size_t
+Lettvin::Anchors::
+equal_avx2 (const uint8_t* a_data, size_t a_from, size_t a_count) const
+//------------------------------------------------------------------------------
+{
+	__m256i b0{_mm256_set1_epi8 (m_bytes[0])};
+	__m256i b1{_mm256_set1_epi8 (m_bytes[1])};
+	__m256i b2{_mm256_set1_epi8 (m_bytes[2])};
+	size_t offset{a_from};
+	for (; offset + 32 <= a_count; offset += 32)
+	{
+		__m256i v{_mm256_loadu_si256 ((const __m256i*)(a_data + offset))};
+		__m256i eq{_mm256_or_si256 (
+				_mm256_or_si256 (
+					_mm256_cmpeq_epi8 (v, b0), _mm256_cmpeq_epi8 (v, b1)),
+				_mm256_cmpeq_epi8 (v, b2))};
+		if (uint32_t mask = _mm256_movemask_epi8 (eq))
+		{
+			return offset + __builtin_ctz (mask);
+		}
+	}
+	return scalar (a_data, offset, a_count);
+} // equal_avx2
+
+//------------------------------------------------------------------------------
+/// @brief nibble-shuffle 16 bytes at a time
+__attribute__ ((target ("ssse3")))
+size_t
+Lettvin::Anchors::
+shufti_ssse3 (const uint8_t* a_data, size_t a_from, size_t a_count) const
+//------------------------------------------------------------------------------
+{
+	__m128i lo{_mm_load_si128 ((const __m128i*)m_lo)};
+	__m128i hi{_mm_load_si128 ((const __m128i*)m_hi)};
+	__m128i nibble{_mm_set1_epi8 (0x0f)};
+	__m128i zero{_mm_setzero_si128 ()};
+	size_t offset{a_from};
+	for (; offset + 16 <= a_count; offset += 16)
+	{
+		__m128i v{_mm_loadu_si128 ((const __m128i*)(a_data + offset))};
+		__m128i l{_mm_shuffle_epi8 (lo, _mm_and_si128 (v, nibble))};
+		__m128i h{_mm_shuffle_epi8 (hi,
+				_mm_and_si128 (_mm_srli_epi16 (v, 4), nibble))};
+		__m128i none{_mm_cmpeq_epi8 (_mm_and_si128 (l, h), zero)};
+		uint32_t mask = ~_mm_movemask_epi8 (none) & 0xffff;
+		while (mask)
+		{
+			size_t found{offset + __builtin_ctz (mask)};
+			if (m_member[a_data[found]]) return found;
+			mask &= mask - 1;
+		}
+	}
+	return scalar (a_data, offset, a_count);
+} // shufti_ssse3
+
+//------------------------------------------------------------------------------
+/// @brief nibble-shuffle 32 bytes at a time
+__attribute__ ((target ("avx2")))
+size_t
+Lettvin::Anchors::
+shufti_avx2 (const uint8_t* a_data, size_t a_from, size_t a_count) const
+//------------------------------------------------------------------------------
+{
+	__m256i lo{_mm256_load_si256 ((const __m256i*)m_lo)};
+	__m256i hi{_mm256_load_si256 ((const __m256i*)m_hi)};
+	__m256i nibble{_mm256_set1_epi8 (0x0f)};
+	__m256i zero{_mm256_setzero_si256 ()};
+	size_t offset{a_from};
+	for (; offset + 32 <= a_count; offset += 32)
+	{
+		__m256i v{_mm256_loadu_si256 ((const __m256i*)(a_data + offset))};
+		__m256i l{_mm256_shuffle_epi8 (lo, _mm256_and_si256 (v, nibble))};
+		__m256i h{_mm256_shuffle_epi8 (hi,
+				_mm256_and_si256 (_mm256_srli_epi16 (v, 4), nibble))};
+		__m256i none{_mm256_cmpeq_epi8 (_mm256_and_si256 (l, h), zero)};
+		uint32_t mask = ~static_cast<uint32_t> (_mm256_movemask_epi8 (none));
+		while (mask)
+		{
+			size_t found{offset + __builtin_ctz (mask)};
+			if (m_member[a_data[found]]) return found;
+			mask &= mask - 1;
+		}
+	}
+	return scalar (a_data, offset, a_count);
+} // shufti_avx2
+
+//------------------------------------------------------------------------------
+/// @brief double nibble-shuffle 16 offsets at a time
+///
+/// Offset o is a candidate when the buckets of byte o (first byte
+/// tables) and byte o+1 (second byte tables) share a bit.
+__attribute__ ((target ("ssse3")))
+size_t
+Lettvin::Pairs::
+shufti_ssse3 (const uint8_t* a_data, size_t a_from, size_t a_count) const
+//------------------------------------------------------------------------------
+{
+	__m128i lo1{_mm_load_si128 ((const __m128i*)m_lo1)};
+	__m128i hi1{_mm_load_si128 ((const __m128i*)m_hi1)};
+	__m128i lo2{_mm_load_si128 ((const __m128i*)m_lo2)};
+	__m128i hi2{_mm_load_si128 ((const __m128i*)m_hi2)};
+	__m128i nibble{_mm_set1_epi8 (0x0f)};
+	__m128i zero{_mm_setzero_si128 ()};
+	size_t offset{a_from};
+	for (; offset + 17 <= a_count; offset += 16)
+	{
+		__m128i v1{_mm_loadu_si128 ((const __m128i*)(a_data + offset))};
+		__m128i v2{_mm_loadu_si128 ((const __m128i*)(a_data + offset + 1))};
+		__m128i b1{_mm_and_si128 (
+				_mm_shuffle_epi8 (lo1, _mm_and_si128 (v1, nibble)),
+				_mm_shuffle_epi8 (hi1,
+					_mm_and_si128 (_mm_srli_epi16 (v1, 4), nibble)))};
+		__m128i b2{_mm_and_si128 (
+				_mm_shuffle_epi8 (lo2, _mm_and_si128 (v2, nibble)),
+				_mm_shuffle_epi8 (hi2,
+					_mm_and_si128 (_mm_srli_epi16 (v2, 4), nibble)))};
+		__m128i none{_mm_cmpeq_epi8 (_mm_and_si128 (b1, b2), zero)};
+		uint32_t mask = ~_mm_movemask_epi8 (none) & 0xffff;
+		while (mask)
+		{
+			size_t found{offset + __builtin_ctz (mask)};
+			if (allowed (a_data[found], a_data[found + 1])) return found;
+			mask &= mask - 1;
+		}
+	}
+	return scalar (a_data, offset, a_count);
+} // shufti_ssse3
+
+//------------------------------------------------------------------------------
+/// @brief double nibble-shuffle 32 offsets at a time
+__attribute__ ((target ("avx2")))
+size_t
+Lettvin::Pairs::
+shufti_avx2 (const uint8_t* a_data, size_t a_from, size_t a_count) const
+//------------------------------------------------------------------------------
+{
+	__m256i lo1{_mm256_load_si256 ((const __m256i*)m_lo1)};
+	__m256i hi1{_mm256_load_si256 ((const __m256i*)m_hi1)};
+	__m256i lo2{_mm256_load_si256 ((const __m256i*)m_lo2)};
+	__m256i hi2{_mm256_load_si256 ((const __m256i*)m_hi2)};
+	__m256i nibble{_mm256_set1_epi8 (0x0f)};
+	__m256i zero{_mm256_setzero_si256 ()};
+	size_t offset{a_from};
+	for (; offset + 33 <= a_count; offset += 32)
+	{
+		__m256i v1{_mm256_loadu_si256 ((const __m256i*)(a_data + offset))};
+		__m256i v2{_mm256_loadu_si256 ((const __m256i*)(a_data + offset + 1))};
+		__m256i b1{_mm256_and_si256 (
+				_mm256_shuffle_epi8 (lo1, _mm256_and_si256 (v1, nibble)),
+				_mm256_shuffle_epi8 (hi1,
+					_mm256_and_si256 (_mm256_srli_epi16 (v1, 4), nibble)))};
+		__m256i b2{_mm256_and_si256 (
+				_mm256_shuffle_epi8 (lo2, _mm256_and_si256 (v2, nibble)),
+				_mm256_shuffle_epi8 (hi2,
+					_mm256_and_si256 (_mm256_srli_epi16 (v2, 4), nibble)))};
+		__m256i none{_mm256_cmpeq_epi8 (_mm256_and_si256 (b1, b2), zero)};
+		uint32_t mask = ~static_cast<uint32_t> (_mm256_movemask_epi8 (none));
+		while (mask)
+		{
+			size_t found{offset + __builtin_ctz (mask)};
+			if (allowed (a_data[found], a_data[found + 1])) return found;
+			mask &= mask - 1;
+		}
+	}
+	return scalar (a_data, offset, a_count);
+} // shufti_avx2
+
+#else
+// Without x86 SIMD, supported () is false for these kernels.
+size_t
+Lettvin::Anchors::
+equal_sse2 (const uint8_t* a_data, size_t a_from, size_t a_count) const
+{ return scalar (a_data, a_from, a_count); }
+size_t
+Lettvin::Anchors::
+equal_avx2 (const uint8_t* a_data, size_t a_from, size_t a_count) const
+{ return scalar (a_data, a_from, a_count); }
+size_t
+Lettvin::Anchors::
+shufti_ssse3 (const uint8_t* a_data, size_t a_from, size_t a_count) const
+{ return scalar (a_data, a_from, a_count); }
+size_t
+Lettvin::Anchors::
+shufti_avx2 (const uint8_t* a_data, size_t a_from, size_t a_count) const
+{ return scalar (a_data, a_from, a_count); }
+size_t
+Lettvin::Pairs::
+shufti_ssse3 (const uint8_t* a_data, size_t a_from, size_t a_count) const
+{ return scalar (a_data, a_from, a_count); }
+size_t
+Lettvin::Pairs::
+shufti_avx2 (const uint8_t* a_data, size_t a_from, size_t a_count) const
+{ return scalar (a_data, a_from, a_count); }
+#endif
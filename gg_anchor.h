@@ -0,0 +1,182 @@
+/*_____________________________________________________________________________
+            The MIT License (https://opensource.org/licenses/MIT)
+
+        Copyright (c) 2017, Jonathan D. Lettvin, All Rights Reserved.
+
+Permission is hereby granted, free of charge, to any person obtaining a copy of
+this software and associated documentation files (the "Software"), to deal in
+the Software without restriction, including without limitation the rights to
+use, copy, modify, merge, publish, distribute, sublicense, and/or sell copies
+of the Software, and to permit persons to whom the Software is furnished to do
+so, subject to the following conditions:
+
+The above copyright notice and this permission notice shall be included in all
+copies or substantial portions of the Software.
+
+THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+SOFTWARE.
+_____________________________________________________________________________*/
+
+#pragma once
+
+#include <cstdint>
+#include <string>
+#include <string_view>
+
+#include "gg_globals.h"
+
+namespace Lettvin
+{
+	using namespace std;
+
+	//CCCCCCCCCCCCCCCCCCCCCCCCCCCCCCCCCCCCCCCCCCCCCCCCCCCCCCCCCCCCCCCCCCCCCCCCCC
+	/// @brief find the next byte belonging to a set (first letters)
+	///
+	/// Replaces string_view::find_first_of, which tests each input byte
+	/// against each set member in turn.
+	/// One byte uses memchr; two or three bytes compare 16 or 32 bytes at
+	/// a time against each; larger sets use the nibble-shuffle ("shufti")
+	/// technique: two PSHUFB lookups on the low and high nibbles yield
+	/// bucket masks whose AND is non-zero for members.
+	/// When more than 8 distinct high nibbles share 8 buckets a candidate
+	/// may be false; candidates are confirmed against a 256-entry table.
+	/// The kernel is chosen at runtime from the CPU's features.
+	//__________________________________________________________________________
+	class
+	Anchors
+	{
+	//------
+	public:
+	//------
+		enum Kernel { NONE, MEMCHR, SCALAR, EQUAL_SSE2, EQUAL_AVX2,
+			SHUFTI_SSSE3, SHUFTI_AVX2, AUTOMATIC };
+
+		static constexpr size_t npos{string_view::npos};
+
+		//----------------------------------------------------------------------
+		Anchors () { assign (""); }
+		Anchors (string_view a_set, Kernel a_kernel=AUTOMATIC)
+		{
+			assign (a_set, a_kernel);
+		}
+
+		//----------------------------------------------------------------------
+		/// @brief build tables for a_set; a_kernel must be supported.
+		void assign (string_view a_set, Kernel a_kernel=AUTOMATIC);
+
+		//----------------------------------------------------------------------
+		/// @brief offset in [a_from, a_count) of the first member, or npos
+		size_t find (const char* a_data, size_t a_from, size_t a_count) const;
+
+		//----------------------------------------------------------------------
+		Kernel      kernel () const { return m_kernel; }
+		const char* name   () const { return name (m_kernel); }
+
+		//----------------------------------------------------------------------
+		static const char* name      (Kernel a_kernel);
+		static bool        supported (Kernel a_kernel);
+
+		//----------------------------------------------------------------------
+		/// @brief compare a_size bytes of a_text with a literal
+		///
+		/// When a_caseless, a_literal holds lower case and ASCII upper case
+		/// in a_text is folded before comparing, 16 bytes at a time.
+		static bool equal (
+				const char* a_text,
+				const char* a_literal,
+				size_t      a_size,
+				bool        a_caseless);
+
+		//----------------------------------------------------------------------
+		/// @brief replace s_frequency with byte counts of a sample corpus
+		static void sample (const char* a_data, size_t a_size);
+
+	//------
+	private:
+	//------
+		size_t shufti_ssse3 (const uint8_t*, size_t, size_t) const;
+		size_t shufti_avx2  (const uint8_t*, size_t, size_t) const;
+		size_t equal_sse2   (const uint8_t*, size_t, size_t) const;
+		size_t equal_avx2   (const uint8_t*, size_t, size_t) const;
+		size_t scalar       (const uint8_t*, size_t, size_t) const;
+
+		alignas (32) uint8_t m_lo[32];        ///< buckets by low nibble
+		alignas (32) uint8_t m_hi[32];        ///< buckets by high nibble
+		bool                 m_member[256];   ///< exact set membership
+		uint8_t              m_bytes[3];      ///< tiny set members
+		size_t               m_count{0};      ///< distinct members
+		Kernel               m_kernel{NONE};
+	}; // class Anchors
+
+	//CCCCCCCCCCCCCCCCCCCCCCCCCCCCCCCCCCCCCCCCCCCCCCCCCCCCCCCCCCCCCCCCCCCCCCCCCC
+	/// @brief find the next byte pair which can begin a string
+	///
+	/// A two-byte ("double") shufti: each first byte's high nibble picks
+	/// one of 8 buckets; the second byte is looked up in that bucket's
+	/// own low and high nibble tables.  Both lookups run on 16 or 32
+	/// adjacent offsets per PSHUFB pair, so a state machine is entered
+	/// only where two bytes (not one) agree with some string.
+	/// Candidates are confirmed against a 65536-bit pair table.
+	//__________________________________________________________________________
+	class
+	Pairs
+	{
+	//------
+	public:
+	//------
+		static constexpr size_t npos{string_view::npos};
+
+		//----------------------------------------------------------------------
+		Pairs () { clear (); }
+
+		//----------------------------------------------------------------------
+		/// @brief forget all pairs
+		void clear ();
+
+		//----------------------------------------------------------------------
+		/// @brief allow strings to begin with a_first then a_second
+		void insert (uint8_t a_first, uint8_t a_second);
+
+		//----------------------------------------------------------------------
+		/// @brief choose a kernel after all inserts; a_kernel must be
+		/// SCALAR, SHUFTI_SSSE3, SHUFTI_AVX2 or AUTOMATIC (and supported).
+		void prepare (Anchors::Kernel a_kernel=Anchors::AUTOMATIC);
+
+		//----------------------------------------------------------------------
+		/// @brief offset in [a_from, a_count - 1) of the first pair, or npos
+		size_t find (const char* a_data, size_t a_from, size_t a_count) const;
+
+		//----------------------------------------------------------------------
+		Anchors::Kernel kernel () const { return m_kernel; }
+		size_t          count  () const { return m_count; }
+
+	//------
+	private:
+	//------
+		size_t shufti_ssse3 (const uint8_t*, size_t, size_t) const;
+		size_t shufti_avx2  (const uint8_t*, size_t, size_t) const;
+		size_t scalar       (const uint8_t*, size_t, size_t) const;
+
+		//----------------------------------------------------------------------
+		bool allowed (uint8_t a_first, uint8_t a_second) const
+		{
+			size_t bit{(size_t (a_first) << 8) | a_second};
+			return (m_pair[bit >> 6] >> (bit & 63)) & 1;
+		}
+
+		alignas (32) uint8_t m_lo1[32];       ///< first byte, low nibble
+		alignas (32) uint8_t m_hi1[32];       ///< first byte, high nibble
+		alignas (32) uint8_t m_lo2[32];       ///< second byte, low nibble
+		alignas (32) uint8_t m_hi2[32];       ///< second byte, high nibble
+		uint64_t             m_pair[1024];    ///< exact pair membership
+		int8_t               m_bucket[16];    ///< bucket by high nibble
+		size_t               m_buckets{0};    ///< high nibbles seen
+		size_t               m_count{0};      ///< distinct pairs
+		Anchors::Kernel      m_kernel{Anchors::NONE};
+	}; // class Pairs
+} // namespace Lettvin
@@ -0,0 +1,1161 @@
+/*_____________________________________________________________________________
+            The MIT License (https://opensource.org/licenses/MIT)
+
+        Copyright (c) 2017, Jonathan D. Lettvin, All Rights Reserved.
+
+Permission is hereby granted, free of charge, to any person obtaining a copy of
+this software and associated documentation files (the "Software"), to deal in
+the Software without restriction, including without limitation the rights to
+use, copy, modify, merge, publish, distribute, sublicense, and/or sell copies
+of the Software, and to permit persons to whom the Software is furnished to do
+so, subject to the following conditions:
+
+The above copyright notice and this permission notice shall be included in all
+copies or substantial portions of the Software.
+
+THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+SOFTWARE.
+_____________________________________________________________________________*/
+
+//..............................................................................
+// Performance measurements which justify choices made in gg.
+// USAGE: gg_bench [{name} [{path}]]   # name defaults to all
+//    open {path}: directory of files to open (default /usr/include)
+//    read {path}: directory for temporary files (default /tmp)
+//    ac   {path}: text to search (default data/pg10681.txt)
+//    anchor {path}: text to skip through (default data/pg10681.txt)
+//    rare {path}: text to search (default data/pg22.txt)
+//    streams {path}: text to search (default data/pg10681.txt)
+//    shift {path}: text to search (default data/pg10681.txt)
+//    tlb  {path}: text to search (default data/pg22.txt)
+//    image {path}: text giving strings (default data/pg22.txt)
+//..............................................................................
+
+//..............................................................................
+#include <dirent.h>
+#include <fcntl.h>                 // file descriptor open O_RDONLY
+#include <unistd.h>                // file descriptor close
+#include <sys/stat.h>              // File status via descriptor
+#include <sys/mman.h>              // mmap, madvise
+#include <sys/syscall.h>           // perf_event_open
+#include <sys/ioctl.h>             // PERF_EVENT_IOC_*
+#include <linux/perf_event.h>      // dTLB miss counter
+
+//..............................................................................
+#include <cstring>                 // memchr
+#include <string>                  // container
+#include <vector>                  // container
+#include <thread>
+#include <mutex>
+#include <fstream>
+#include <sstream>
+#include <set>
+
+#if defined (__x86_64__) || defined (__i386__)
+#include <x86intrin.h>             // __rdtsc
+#endif
+
+//..............................................................................
+#include "gg.h"                    // interval and declarations
+
+using namespace std;
+using namespace Lettvin;
+
+//------------------------------------------------------------------------------
+/// @brief collect up to a_limit regular filenames below a_path
+void
+files (vs_t& a_target, const string& a_path, size_t a_limit=1 << 14)
+//------------------------------------------------------------------------------
+{
+	if (auto dir = opendir (a_path.c_str ()))
+	{
+		while (auto f = readdir (dir))
+		{
+			if (a_target.size () >= a_limit) break;
+			string name{f->d_name};
+			if (name == "." || name == "..") continue;
+			string path{a_path + "/" + name};
+			if (f->d_type == DT_DIR) files (a_target, path, a_limit);
+			else if (f->d_type == DT_REG) a_target.push_back (path);
+		}
+		closedir (dir);
+	}
+} // files
+
+//------------------------------------------------------------------------------
+/// @brief opens/sec scaling with thread count
+///
+/// Compares a global mutex around open (the former open_mtx)
+/// with the lock-free FdBudget now used by mapped_search.
+void
+bench_open (const string& a_path)
+//------------------------------------------------------------------------------
+{
+	vs_t names;
+	files (names, a_path);
+	if (names.empty ())
+	{
+		printf (" # gg bench open: no files found in %s\n", a_path.c_str ());
+		return;
+	}
+	static const size_t passes{4};
+
+	auto opens = [&names] (size_t a_threads, mutex* a_serialize)
+	{
+		FdBudget budget;
+		auto work = [&] (size_t a_first)
+		{
+			for (size_t pass=0; pass < passes; ++pass)
+			{
+				for (size_t i=a_first; i < names.size (); i += a_threads)
+				{
+					int fd{-1};
+					budget.acquire ();
+					if (a_serialize)
+					{
+						lock_guard<mutex> lck (*a_serialize);
+						fd = open (names[i].c_str (), O_RDONLY, 0);
+					}
+					else
+					{
+						fd = open (names[i].c_str (), O_RDONLY, 0);
+					}
+					struct stat st;
+					if (fd >= 0) fstat (fd, &st), close (fd);
+					budget.release ();
+				}
+			}
+		};
+		double seconds = interval ([&] ()
+		{
+			vector<thread> threads;
+			for (size_t t=0; t < a_threads; ++t)
+			{
+				threads.emplace_back (work, t);
+			}
+			for (auto& thrd:threads) thrd.join ();
+		});
+		return double (passes * names.size ()) / seconds;
+	};
+
+	mutex serialize;
+	printf (" # gg bench open: %zu files from %s (%u cores)\n",
+			names.size (), a_path.c_str (), thread::hardware_concurrency ());
+	for (size_t threads=1; threads <= 64; threads *= 2)
+	{
+		double locked{opens (threads, &serialize)};
+		double budget{opens (threads, nullptr)};
+		printf (" # gg bench open: threads %2zu"
+				" mutex %10.0f opens/s budget %10.0f opens/s (x%.2f)\n",
+				threads, locked, budget, budget / locked);
+	}
+} // bench_open
+
+//------------------------------------------------------------------------------
+/// @brief pread versus mmap cost per file as file size grows
+///
+/// Justifies the s_pread default: below the crossover a pread into a
+/// reusable buffer beats mmap page-table setup and teardown.
+/// Every byte is touched (memchr for an absent byte) as a scan would.
+void
+bench_read (const string& a_dir)
+//------------------------------------------------------------------------------
+{
+	static const size_t total{1 << 25};   // bytes per size class
+	static const size_t most{1 << 11};    // files per size class
+	string root{a_dir + "/gg_bench_read"};
+	mkdir (root.c_str (), 0700);
+
+	vector<char> content (1 << 20, 'a');
+	char* buffer{static_cast<char*> (aligned_alloc (4096, 1 << 20))};
+	size_t sink{0};
+	printf (" # gg bench read: ns/file (warm cache) in %s\n", root.c_str ());
+
+	for (size_t bytes=1 << 10; bytes <= (1 << 20); bytes <<= 2)
+	{
+		size_t count{min (most, total / bytes)};
+		vs_t names;
+		for (size_t i=0; i < count; ++i)
+		{
+			names.emplace_back (fmt::format ("{}/{}.{}", root, bytes, i));
+			int fd = open (names.back ().c_str (), O_WRONLY|O_CREAT|O_TRUNC, 0600);
+			if (fd < 0 || write (fd, content.data (), bytes) != ssize_t (bytes))
+			{
+				printf (" # gg bench read: cannot write %s\n", root.c_str ());
+				return;
+			}
+			close (fd);
+		}
+
+		auto each = [&] (auto a_read)
+		{
+			a_read ();  // warm the cache
+			return 1e9 * interval (a_read) / double (count);
+		};
+		double pread_ns = each ([&] ()
+		{
+			for (auto& name:names)
+			{
+				int fd = open (name.c_str (), O_RDONLY);
+				struct stat st;
+				fstat (fd, &st);
+				ssize_t got = pread (fd, buffer, st.st_size, 0);
+				sink += memchr (buffer, 'z', got) != nullptr;
+				close (fd);
+			}
+		});
+		auto mapped = [&] (int a_flags, bool a_advise)
+		{
+			return each ([&] ()
+			{
+				for (auto& name:names)
+				{
+					int fd = open (name.c_str (), O_RDONLY);
+					struct stat st;
+					fstat (fd, &st);
+					void* p = mmap (NULL, st.st_size, PROT_READ, a_flags, fd, 0);
+					if (a_advise) madvise (p, st.st_size, MADV_SEQUENTIAL);
+					sink += memchr (p, 'z', st.st_size) != nullptr;
+					munmap (p, st.st_size);
+					close (fd);
+				}
+			});
+		};
+		double populate_ns{mapped (MAP_PRIVATE | MAP_POPULATE, false)};
+		double sequential_ns{mapped (MAP_PRIVATE, true)};
+
+		printf (" # gg bench read: %8zu bytes"
+				" pread %8.0f mmap+populate %8.0f mmap+sequential %8.0f\n",
+				bytes, pread_ns, populate_ns, sequential_ns);
+		for (auto& name:names) unlink (name.c_str ());
+	}
+	rmdir (root.c_str ());
+	free (buffer);
+	if (sink) printf (" # gg bench read: unexpected 'z'\n");
+} // bench_read
+
+//------------------------------------------------------------------------------
+/// @brief MB/s of restarting versus Aho-Corasick linked Table scan
+///
+/// Common-letter strings make nearly every byte an anchor, which is the
+/// worst case for restarting at each anchor.  One absent string keeps the
+/// completion optimization from ending the scan early.
+void
+bench_ac (const string& a_path)
+//------------------------------------------------------------------------------
+{
+	ifstream file (a_path);
+	stringstream ss;
+	ss << file.rdbuf ();
+	string contents{ss.str ()};
+	if (contents.empty ())
+	{
+		printf (" # gg bench ac: cannot read %s\n", a_path.c_str ());
+		return;
+	}
+
+	const vs_t strings{"the", "and", "that", "tion", "ere", "ent", "est",
+		"here", "there", "other", "ation", "national", "zzqqx"};
+	auto accept{s_accept};
+	auto firsts{s_firsts};
+	s_accept = vsv_t{""};
+	for (auto& str:strings) s_accept.emplace_back (str);
+
+	Table restart, linked;
+	for (size_t index=0; index < strings.size (); ++index)
+	{
+		restart.insert (strings[index], index + 1);
+		linked.insert (strings[index], index + 1);
+	}
+	size_t wide{restart.size () * restart.stride () * sizeof (Transition)};
+	linked.seal ();
+	size_t narrow{linked.size () * linked.stride () * sizeof (Transition)};
+
+	auto rate = [&] (Table& a_table)
+	{
+		Tally tally;
+		auto scan = [&] ()
+		{
+			for (size_t pass=0; pass < 8; ++pass)
+			{
+				tally = Tally{};
+				a_table.scan (contents.data (), contents.size (),
+						contents.size (), tally);
+			}
+		};
+		scan ();  // warm the cache
+		double seconds{interval (scan)};
+		return make_pair (8e-6 * contents.size () / seconds,
+				tally.accepts ());
+	};
+	auto slow{rate (restart)};
+	auto fast{rate (linked)};
+	printf (" # gg bench ac: %zu bytes %zu strings"
+			" restart %7.1f MB/s linked %7.1f MB/s (%zu/%zu found)\n",
+			contents.size (), strings.size (),
+			slow.first, fast.first, slow.second - 1, fast.second - 1);
+	printf (" # gg bench ac: table %zu bytes, sealed %zu bytes (%zu classes)\n",
+			wide, narrow, linked.stride ());
+	s_firsts = firsts;
+	s_accept = accept;
+} // bench_ac
+
+//------------------------------------------------------------------------------
+/// @brief GB/s skipping to first letters: find_first_of versus Anchors
+///
+/// Rare first letters make this a sparse-match corpus so skipping,
+/// not the FSM, dominates the search.
+void
+bench_anchor (const string& a_path)
+//------------------------------------------------------------------------------
+{
+	ifstream file (a_path);
+	stringstream ss;
+	ss << file.rdbuf ();
+	string contents{ss.str ()};
+	if (contents.empty ())
+	{
+		printf (" # gg bench anchor: cannot read %s\n", a_path.c_str ());
+		return;
+	}
+	string_view view (contents);
+	const Anchors::Kernel kernels[]{
+		Anchors::MEMCHR, Anchors::EQUAL_SSE2, Anchors::EQUAL_AVX2,
+		Anchors::SCALAR, Anchors::SHUFTI_SSSE3, Anchors::SHUFTI_AVX2};
+
+	for (string set:{"Q", "QZ", "QZX", "QZXJ", "QZXJ@#$%^&*<>{}"})
+	{
+		size_t hits{0};
+		auto gbps = [&] (auto a_find)
+		{
+			auto all = [&] ()
+			{
+				hits = 0;
+				for (size_t at=a_find (0); at != string_view::npos;
+						at=a_find (at + 1))
+				{
+					++hits;
+				}
+			};
+			all ();  // warm the cache
+			return 1e-9 * contents.size () / interval (all);
+		};
+		printf (" # gg bench anchor: %-16s find_first_of %6.2f GB/s",
+				set.c_str (),
+				gbps ([&] (size_t a_from)
+				{
+					return view.find_first_of (set, a_from);
+				}));
+		for (auto kernel:kernels)
+		{
+			if (!Anchors::supported (kernel)) continue;
+			if (kernel == Anchors::MEMCHR && set.size () > 1) continue;
+			if ((kernel == Anchors::EQUAL_SSE2 || kernel == Anchors::EQUAL_AVX2)
+					&& set.size () > 3) continue;
+			Anchors anchors (set, kernel);
+			printf (" %s %6.2f", anchors.name (),
+					gbps ([&] (size_t a_from)
+					{
+						return anchors.find (
+								contents.data (), a_from, contents.size ());
+					}));
+		}
+		printf (" (%zu anchors)\n", hits);
+	}
+} // bench_anchor
+
+//------------------------------------------------------------------------------
+/// @brief MB/s anchoring on first letters versus on rare bytes
+///
+/// Caseless strings beginning with common letters.  A flat frequency
+/// table makes every byte equally rare so sealing keeps first letters;
+/// the built-in table lets sealing choose rare bytes.
+void
+bench_rare (const string& a_path)
+//------------------------------------------------------------------------------
+{
+	ifstream file (a_path);
+	stringstream ss;
+	ss << file.rdbuf ();
+	string contents{ss.str ()};
+	if (contents.empty ())
+	{
+		printf (" # gg bench rare: cannot read %s\n", a_path.c_str ());
+		return;
+	}
+
+	const vs_t strings{"should", "through", "something", "together",
+		"themselves", "whichever", "zzqqx"};
+	auto accept{s_accept};
+	auto firsts{s_firsts};
+	auto frequency{s_frequency};
+	auto caseless{s_caseless};
+	s_caseless = true;
+	s_accept = vsv_t{""};
+	for (auto& str:strings) s_accept.emplace_back (str);
+
+	auto rate = [&] (bool a_flat)
+	{
+		s_firsts.clear ();
+		s_frequency = frequency;
+		if (a_flat) s_frequency.fill (1);
+		Table table;
+		for (size_t index=0; index < strings.size (); ++index)
+		{
+			table.insert (strings[index], index + 1);
+		}
+		table.seal ();
+		Tally tally;
+		auto scan = [&] ()
+		{
+			for (size_t pass=0; pass < 8; ++pass)
+			{
+				tally = Tally{};
+				table.scan (contents.data (), contents.size (),
+						contents.size (), tally);
+			}
+		};
+		scan ();  // warm the cache
+		double seconds{interval (scan)};
+		return make_pair (8e-6 * contents.size () / seconds,
+				tally.accepts ());
+	};
+	auto first{rate (true)};
+	auto rare{rate (false)};
+	printf (" # gg bench rare: %zu bytes %zu caseless strings"
+			" first %7.1f MB/s rare %7.1f MB/s (%zu/%zu found)\n",
+			contents.size (), strings.size (),
+			first.first, rare.first, first.second - 1, rare.second - 1);
+	s_caseless = caseless;
+	s_frequency = frequency;
+	s_firsts = firsts;
+	s_accept = accept;
+} // bench_rare
+
+//------------------------------------------------------------------------------
+/// @brief bytes/cycle of one stream (with skipping) versus 2, 4, 8 streams
+///
+/// Thousands of words from the text, each made absent by a suffix, make
+/// a table too large for L1 and nearly every byte an anchor,
+/// so one stream waits on loads.
+void
+bench_streams (const string& a_path)
+//------------------------------------------------------------------------------
+{
+#if defined (__x86_64__) || defined (__i386__)
+	ifstream file (a_path);
+	stringstream ss;
+	ss << file.rdbuf ();
+	string contents{ss.str ()};
+	if (contents.empty ())
+	{
+		printf (" # gg bench streams: cannot read %s\n", a_path.c_str ());
+		return;
+	}
+
+	vs_t strings;
+	set<string> unique;
+	stringstream words (contents);
+	for (string word; words >> word && strings.size () < 4000;)
+	{
+		// Absent (so grp handling does not dominate) but with common prefixes.
+		if (word.size () >= 5 && unique.insert (word).second)
+		{
+			strings.push_back (word + "#");
+		}
+	}
+	strings.push_back ("zzqqxzzqqx");
+
+	auto accept{s_accept};
+	auto firsts{s_firsts};
+	auto streams{s_streams};
+	s_accept = vsv_t{""};
+	for (auto& str:strings) s_accept.emplace_back (str);
+	Table table;
+	for (size_t index=0; index < strings.size (); ++index)
+	{
+		table.insert (strings[index], index + 1);
+	}
+	table.seal ();
+
+	printf (" # gg bench streams: %zu bytes %zu strings %zu planes:",
+			contents.size (), strings.size (), table.size ());
+	for (size_t count:{1, 2, 4, 8})
+	{
+		s_streams = count;
+		Tally tally;
+		table.scan (contents.data (), contents.size (), contents.size (), tally);
+		uint64_t t0{__rdtsc ()};
+		for (size_t pass=0; pass < 4; ++pass)
+		{
+			tally = Tally{};
+			table.scan (contents.data (), contents.size (),
+					contents.size (), tally);
+		}
+		uint64_t cycles{__rdtsc () - t0};
+		printf (" %zu:%.3f", count, 4.0 * contents.size () / cycles);
+	}
+	printf (" bytes/cycle\n");
+	s_streams = streams;
+	s_firsts = firsts;
+	s_accept = accept;
+#else
+	printf (" # gg bench streams: needs a cycle counter (x86)\n");
+#endif
+} // bench_streams
+
+//------------------------------------------------------------------------------
+/// @brief MB/s of the planes versus the Shift-And engine for small sets
+///
+/// Frequencies are flattened so both keep first-letter anchoring.
+void
+bench_shift (const string& a_path)
+//------------------------------------------------------------------------------
+{
+	ifstream file (a_path);
+	stringstream ss;
+	ss << file.rdbuf ();
+	string contents{ss.str ()};
+	if (contents.empty ())
+	{
+		printf (" # gg bench shift: cannot read %s\n", a_path.c_str ());
+		return;
+	}
+
+	auto accept{s_accept};
+	auto firsts{s_firsts};
+	auto frequency{s_frequency};
+	auto shift{s_shift};
+	s_frequency.fill (1);
+	for (vs_t strings:{vs_t{"copyright", "zzqqx"},
+			vs_t{"gutenberg", "project", "license", "zzqqx"},
+			vs_t{"heaven", "earth", "water", "light", "night", "zzqqx"}})
+	{
+		s_accept = vsv_t{""};
+		for (auto& str:strings) s_accept.emplace_back (str);
+		auto rate = [&] (size_t a_shift)
+		{
+			s_shift = a_shift;
+			s_firsts.clear ();
+			Table table;
+			for (size_t index=0; index < strings.size (); ++index)
+			{
+				table.insert (strings[index], index + 1);
+			}
+			table.seal ();
+			auto scan = [&] ()
+			{
+				for (size_t pass=0; pass < 8; ++pass)
+				{
+					Tally tally;
+					table.scan (contents.data (), contents.size (),
+							contents.size (), tally);
+				}
+			};
+			scan ();  // warm the cache
+			return 8e-6 * contents.size () / interval (scan);
+		};
+		double planes{rate (0)};
+		double bits{rate (128)};
+		printf (" # gg bench shift: %zu strings planes %7.1f MB/s"
+				" shift-and %7.1f MB/s\n", strings.size (), planes, bits);
+	}
+	s_shift = shift;
+	s_frequency = frequency;
+	s_firsts = firsts;
+	s_accept = accept;
+} // bench_shift
+
+//------------------------------------------------------------------------------
+/// @brief MB/s of the planes versus the Wu-Manber engine for large sets
+///
+/// Strings are reversed words of the text (so few are found and no scan
+/// completes early); the sets grow from 64 to 4096 strings.
+void
+bench_manber (const string& a_path)
+//------------------------------------------------------------------------------
+{
+	ifstream file (a_path);
+	stringstream ss;
+	ss << file.rdbuf ();
+	string contents{ss.str ()};
+	if (contents.empty ())
+	{
+		printf (" # gg bench manber: cannot read %s\n", a_path.c_str ());
+		return;
+	}
+
+	set<string> words;
+	{
+		stringstream text (contents);
+		for (string word; text >> word;)
+		{
+			if (word.size () < 5) continue;
+			bool alpha{true};
+			for (auto c:word) alpha &= isalpha (uint8_t (c)) != 0;
+			if (alpha) words.emplace (word.rbegin (), word.rend ());
+		}
+	}
+
+	auto accept{s_accept};
+	auto firsts{s_firsts};
+	auto manber{s_manber};
+	for (size_t count:{64, 256, 1024, 4096})
+	{
+		vs_t strings;
+		for (auto& word:words)
+		{
+			if (strings.size () == count) break;
+			strings.push_back (word);
+		}
+		s_accept = vsv_t{""};
+		for (auto& str:strings) s_accept.emplace_back (str);
+		auto rate = [&] (size_t a_manber)
+		{
+			s_manber = a_manber;
+			s_firsts.clear ();
+			Table table;
+			for (size_t index=0; index < strings.size (); ++index)
+			{
+				table.insert (strings[index], index + 1);
+			}
+			table.seal ();
+			auto scan = [&] ()
+			{
+				for (size_t pass=0; pass < 4; ++pass)
+				{
+					Tally tally;
+					table.scan (contents.data (), contents.size (),
+							contents.size (), tally);
+				}
+			};
+			scan ();  // warm the cache
+			return 4e-6 * contents.size () / interval (scan);
+		};
+		double planes{rate (0)};
+		double blocks{rate (64)};
+		printf (" # gg bench manber: %4zu strings planes %7.1f MB/s"
+				" wu-manber %7.1f MB/s\n", strings.size (), planes, blocks);
+	}
+	s_manber = manber;
+	s_firsts = firsts;
+	s_accept = accept;
+} // bench_manber
+
+//------------------------------------------------------------------------------
+/// @brief MB/s of the planes loop with its mode read at run time or fixed
+///
+/// Table::sweep<Dynamic> tests the globals inside the loop as scan once
+/// did; scan now dispatches to a Fixed instantiation before looping.
+/// The ac strings make nearly every byte an anchor, so the loop dominates.
+void
+bench_policy (const string& a_path)
+//------------------------------------------------------------------------------
+{
+	ifstream file (a_path);
+	stringstream ss;
+	ss << file.rdbuf ();
+	string contents{ss.str ()};
+	if (contents.empty ())
+	{
+		printf (" # gg bench policy: cannot read %s\n", a_path.c_str ());
+		return;
+	}
+
+	const vs_t strings{"the", "and", "that", "tion", "ere", "ent", "est",
+		"here", "there", "other", "ation", "national", "zzqqx"};
+	auto accept{s_accept};
+	auto firsts{s_firsts};
+	auto shift{s_shift};
+	s_shift = 0;
+	s_accept = vsv_t{""};
+	for (auto& str:strings) s_accept.emplace_back (str);
+
+	Table restart, linked;
+	for (size_t index=0; index < strings.size (); ++index)
+	{
+		restart.insert (strings[index], index + 1);
+		linked.insert (strings[index], index + 1);
+	}
+	linked.seal ();
+
+	auto rate = [&] (Table& a_table, bool a_fixed)
+	{
+		auto scan = [&] ()
+		{
+			for (size_t pass=0; pass < 8; ++pass)
+			{
+				Tally tally;
+				if (a_fixed)
+				{
+					a_table.scan (contents.data (), contents.size (),
+							contents.size (), tally);
+				}
+				else
+				{
+					a_table.sweep<Table::Dynamic> (contents.data (),
+							contents.size (), contents.size (), tally);
+				}
+			}
+		};
+		scan ();  // warm the cache
+		return 8e-6 * contents.size () / interval (scan);
+	};
+	for (auto* table:{&restart, &linked})
+	{
+		double dynamic{rate (*table, false)};
+		double fixed  {rate (*table, true)};
+		printf (" # gg bench policy: %-7s dynamic %7.1f MB/s fixed %7.1f MB/s\n",
+				table == &restart ? "restart" : "linked", dynamic, fixed);
+	}
+	s_shift = shift;
+	s_firsts = firsts;
+	s_accept = accept;
+} // bench_policy
+
+//------------------------------------------------------------------------------
+/// @brief count of trie states (distinct prefixes) of a_strings
+size_t
+trie_states (const vs_t& a_strings)
+//------------------------------------------------------------------------------
+{
+	set<string_view> prefixes;
+	for (auto& str:a_strings)
+	{
+		for (size_t size=1; size <= str.size (); ++size)
+		{
+			prefixes.insert (string_view (str).substr (0, size));
+		}
+	}
+	return prefixes.size ();
+} // trie_states
+
+//------------------------------------------------------------------------------
+/// @brief memory and MB/s of dense planes versus the double-array trie
+///
+/// Strings are distinct words of the text with numeric suffixes, so most
+/// are found rarely.  Dense planes are built only while they fit 1GiB;
+/// their peak is the unsealed size (before minimizing and compressing).
+void
+bench_sparse (const string& a_path)
+//------------------------------------------------------------------------------
+{
+	ifstream file (a_path);
+	stringstream ss;
+	ss << file.rdbuf ();
+	string contents{ss.str ()};
+	if (contents.empty ())
+	{
+		printf (" # gg bench sparse: cannot read %s\n", a_path.c_str ());
+		return;
+	}
+
+	vs_t words;
+	{
+		set<string> distinct;
+		stringstream text (contents);
+		for (string word; text >> word;)
+		{
+			if (word.size () < 3) continue;
+			bool alpha{true};
+			for (auto c:word) alpha &= isalpha (uint8_t (c)) != 0;
+			if (alpha && distinct.insert (word).second) words.push_back (word);
+		}
+	}
+
+	auto accept{s_accept};
+	auto firsts{s_firsts};
+	auto manber{s_manber};
+	auto shift{s_shift};
+	auto budget{s_budget};
+	s_manber = s_shift = 0;
+	for (size_t count:{1000, 10000, 100000})
+	{
+		vs_t strings;
+		for (size_t suffix=0; strings.size () < count; ++suffix)
+		{
+			for (auto& word:words)
+			{
+				if (strings.size () == count) break;
+				strings.push_back (suffix ? word + to_string (suffix) : word);
+			}
+		}
+		s_accept = vsv_t{""};
+		for (auto& str:strings) s_accept.emplace_back (str);
+		auto rate = [&] (size_t a_budget, size_t& a_peak, size_t& a_bytes)
+		{
+			s_budget = a_budget;
+			s_firsts.clear ();
+			Table table;
+			for (size_t index=0; index < strings.size (); ++index)
+			{
+				table.insert (strings[index], index + 1);
+			}
+			a_peak = table.size () * table.stride () * sizeof (Transition);
+			auto start{chrono::steady_clock::now ()};
+			table.seal ();
+			double sealing{chrono::duration<double> (
+					chrono::steady_clock::now () - start).count ()};
+			a_bytes = table.sparse () ? table.bytes ()
+				: table.size () * table.stride () * sizeof (Transition);
+			auto scan = [&] ()
+			{
+				Tally tally;
+				table.scan (contents.data (), contents.size (),
+						contents.size (), tally);
+			};
+			scan ();  // warm the cache
+			return make_pair (1e-6 * contents.size () / interval (scan), sealing);
+		};
+		size_t peak{0}, bytes{0};
+		// Estimate the dense peak from the trie: one plane per state.
+		auto trie{rate (0, peak, bytes)};
+		printf (" # gg bench sparse: %6zu strings double-array %8.1f MB"
+				" %7.1f MB/s (sealed in %.2fs)\n",
+				count, bytes * 1e-6, trie.first, trie.second);
+		size_t dense{(trie_states (strings) + 2) * 256 * sizeof (Transition)};
+		if (dense > (size_t (1) << 30))
+		{
+			printf (" # gg bench sparse: %6zu strings planes %8.1f MB"
+					" (estimated peak, not built)\n", count, dense * 1e-6);
+			continue;
+		}
+		auto planes{rate (budget, peak, bytes)};
+		printf (" # gg bench sparse: %6zu strings planes %8.1f MB peak"
+				" %8.1f MB sealed %7.1f MB/s\n",
+				count, peak * 1e-6, bytes * 1e-6, planes.first);
+	}
+	s_budget = budget;
+	s_shift = shift;
+	s_manber = manber;
+	s_firsts = firsts;
+	s_accept = accept;
+} // bench_sparse
+
+//------------------------------------------------------------------------------
+/// @brief count user-space dTLB read misses while a_fun runs
+///
+/// Returns -1 when the kernel refuses the counter (perf_event_paranoid,
+/// a container without perf, or no such hardware event).
+template<typename T>
+long long
+dtlb_misses (T a_fun)
+//------------------------------------------------------------------------------
+{
+	perf_event_attr attr;
+	memset (&attr, 0, sizeof (attr));
+	attr.size           = sizeof (attr);
+	attr.type           = PERF_TYPE_HW_CACHE;
+	attr.config         = PERF_COUNT_HW_CACHE_DTLB |
+		(PERF_COUNT_HW_CACHE_OP_READ << 8) |
+		(PERF_COUNT_HW_CACHE_RESULT_MISS << 16);
+	attr.disabled       = 1;
+	attr.exclude_kernel = 1;
+	attr.exclude_hv     = 1;
+	int fd{int (syscall (SYS_perf_event_open, &attr, 0, -1, -1, 0))};
+	if (fd < 0)
+	{
+		a_fun ();
+		return -1;
+	}
+	ioctl (fd, PERF_EVENT_IOC_RESET, 0);
+	ioctl (fd, PERF_EVENT_IOC_ENABLE, 0);
+	a_fun ();
+	ioctl (fd, PERF_EVENT_IOC_DISABLE, 0);
+	long long count{-1};
+	if (read (fd, &count, sizeof (count)) != sizeof (count)) count = -1;
+	close (fd);
+	return count;
+} // dtlb_misses
+
+//------------------------------------------------------------------------------
+/// @brief MB/s and dTLB misses of a large table on 4KiB versus 2MiB pages
+///
+/// Forty thousand words with numeric suffixes give planes of tens of MB
+/// which are scanned without skipping (nearly every letter is a first
+/// letter), so nearly every byte is a transition into some page.
+/// Planes are renumbered breadth-first in both cases; only --huge differs.
+void
+bench_tlb (const string& a_path)
+//------------------------------------------------------------------------------
+{
+	ifstream file (a_path);
+	stringstream ss;
+	ss << file.rdbuf ();
+	string contents{ss.str ()};
+	if (contents.empty ())
+	{
+		printf (" # gg bench tlb: cannot read %s\n", a_path.c_str ());
+		return;
+	}
+
+	vs_t strings;
+	{
+		set<string> distinct;
+		stringstream text (contents);
+		for (string word; text >> word && strings.size () < 40000;)
+		{
+			if (word.size () < 3) continue;
+			bool alpha{true};
+			for (auto c:word) alpha &= isalpha (uint8_t (c)) != 0;
+			if (alpha && distinct.insert (word).second) strings.push_back (word);
+		}
+		for (size_t suffix=1; strings.size () < 40000; ++suffix)
+		{
+			for (size_t index=0; index < distinct.size () &&
+					strings.size () < 40000; ++index)
+			{
+				strings.push_back (strings[index] + to_string (suffix));
+			}
+		}
+	}
+
+	auto accept{s_accept};
+	auto firsts{s_firsts};
+	auto manber{s_manber};
+	auto shift{s_shift};
+	auto huge{s_huge};
+	s_manber = s_shift = 0;
+	s_accept = vsv_t{""};
+	for (auto& str:strings) s_accept.emplace_back (str);
+	for (size_t pages:{size_t (0), huge ? huge : size_t (1) << 21})
+	{
+		s_huge = pages;
+		s_firsts.clear ();
+		Table table;
+		for (size_t index=0; index < strings.size (); ++index)
+		{
+			table.insert (strings[index], index + 1);
+		}
+		table.seal ();
+		auto scan = [&] ()
+		{
+			for (size_t pass=0; pass < 4; ++pass)
+			{
+				Tally tally;
+				table.scan (contents.data (), contents.size (),
+						contents.size (), tally);
+			}
+		};
+		scan ();  // warm the cache
+		double seconds{0.0};
+		long long misses{dtlb_misses ([&] () { seconds = interval (scan); })};
+		double rate{4e-6 * contents.size () / seconds};
+		size_t bytes{table.size () * table.stride () * sizeof (Transition)};
+		if (misses < 0)
+		{
+			printf (" # gg bench tlb: %s pages %8.1f MB %7.1f MB/s"
+					" (dTLB counter unavailable)\n",
+					pages ? "2MiB" : "4KiB", bytes * 1e-6, rate);
+		}
+		else
+		{
+			printf (" # gg bench tlb: %s pages %8.1f MB %7.1f MB/s"
+					" %8.3f dTLB misses/KB\n",
+					pages ? "2MiB" : "4KiB", bytes * 1e-6, rate,
+					1e3 * misses / (4.0 * contents.size ()));
+		}
+	}
+	s_huge = huge;
+	s_shift = shift;
+	s_manber = manber;
+	s_firsts = firsts;
+	s_accept = accept;
+} // bench_tlb
+
+//------------------------------------------------------------------------------
+/// @brief seconds to compile a large set versus to load its dumped image
+///
+/// Words of the text with numeric suffixes, as for bench sparse.
+/// Loading verifies the checksum, so it reads the whole image once.
+void
+bench_image (const string& a_path)
+//------------------------------------------------------------------------------
+{
+	ifstream file (a_path);
+	stringstream ss;
+	ss << file.rdbuf ();
+	string contents{ss.str ()};
+	if (contents.empty ())
+	{
+		printf (" # gg bench image: cannot read %s\n", a_path.c_str ());
+		return;
+	}
+
+	vs_t strings;
+	{
+		set<string> distinct;
+		stringstream text (contents);
+		for (string word; text >> word && strings.size () < 20000;)
+		{
+			if (word.size () < 3) continue;
+			bool alpha{true};
+			for (auto c:word) alpha &= isalpha (uint8_t (c)) != 0;
+			if (alpha && distinct.insert (word).second) strings.push_back (word);
+		}
+		for (size_t suffix=1; strings.size () < 20000; ++suffix)
+		{
+			for (size_t index=0; index < distinct.size () &&
+					strings.size () < 20000; ++index)
+			{
+				strings.push_back (strings[index] + to_string (suffix));
+			}
+		}
+	}
+
+	auto accept{s_accept};
+	auto firsts{s_firsts};
+	auto manber{s_manber};
+	s_manber = 0;
+	s_accept = vsv_t{""};
+	s_firsts.clear ();
+	for (auto& str:strings) s_accept.emplace_back (str);
+	const char* image{"/tmp/gg_bench.table"};
+	size_t planes{0};
+	double compile{interval ([&] ()
+	{
+		Table table;
+		for (size_t index=0; index < strings.size (); ++index)
+		{
+			table.insert (strings[index], index + 1);
+		}
+		table.seal ();
+		table.dump (image, "bench image");
+		planes = table.size ();
+	})};
+	bool loaded{false};
+	double load{interval ([&] ()
+	{
+		Table table;
+		loaded = table.load (image);
+	})};
+	struct stat st;
+	size_t bytes{stat (image, &st) ? 0 : size_t (st.st_size)};
+	printf (" # gg bench image: %zu strings %zu planes: compile+dump %.3fs,"
+			" load %.4fs%s (%.1f MB image)\n", strings.size (), planes,
+			compile, load, loaded ? "" : " FAILED", bytes * 1e-6);
+	unlink (image);
+	s_manber = manber;
+	s_firsts = firsts;
+	s_accept = accept;
+} // bench_image
+
+//------------------------------------------------------------------------------
+/// @brief MB/s of byte planes versus nibble planes skipping to pairs
+///
+/// Shapes change only once per process, so this runs last: byte planes
+/// first, then s_shape (true) for nibble planes.  Also counts anchors
+/// found by first letters versus first two letters (Pairs).
+void
+bench_nibble (const string& a_path)
+//------------------------------------------------------------------------------
+{
+	ifstream file (a_path);
+	stringstream ss;
+	ss << file.rdbuf ();
+	string contents{ss.str ()};
+	if (contents.empty ())
+	{
+		printf (" # gg bench nibble: cannot read %s\n", a_path.c_str ());
+		return;
+	}
+
+	const vs_t strings{"the", "and", "that", "tion", "ere", "ent", "est",
+		"here", "there", "other", "ation", "national", "zzqqx"};
+	auto accept{s_accept};
+	auto firsts{s_firsts};
+	auto shift{s_shift};
+	s_shift = 0;
+	s_accept = vsv_t{""};
+	s_firsts.clear ();
+	for (auto& str:strings)
+	{
+		s_accept.emplace_back (str);
+		s_firsts += str[0];
+	}
+
+	auto rate = [&] ()
+	{
+		Table table;
+		for (size_t index=0; index < strings.size (); ++index)
+		{
+			table.insert (strings[index], index + 1);
+		}
+		table.seal ();
+		auto scan = [&] ()
+		{
+			for (size_t pass=0; pass < 8; ++pass)
+			{
+				Tally tally;
+				table.scan (contents.data (), contents.size (),
+						contents.size (), tally);
+			}
+		};
+		scan ();  // warm the cache
+		return make_pair (8e-6 * contents.size () / interval (scan),
+				table.size () * table.stride () * sizeof (Transition));
+	};
+	auto bytes{rate ()};
+	s_shape (true);
+	auto nibbles{rate ()};
+	printf (" # gg bench nibble: bytes %7.1f MB/s (%zu table bytes)"
+			" nibbles %7.1f MB/s (%zu table bytes)\n",
+			bytes.first, bytes.second, nibbles.first, nibbles.second);
+
+	Anchors anchors (s_firsts);
+	Pairs pairs;
+	for (auto& str:strings) pairs.insert (str[0], str[1]);
+	pairs.prepare ();
+	size_t singles{0}, doubles{0};
+	for (size_t at=anchors.find (contents.data (), 0, contents.size ());
+			at != Anchors::npos;
+			at=anchors.find (contents.data (), at + 1, contents.size ())) ++singles;
+	for (size_t at=pairs.find (contents.data (), 0, contents.size ());
+			at != Pairs::npos;
+			at=pairs.find (contents.data (), at + 1, contents.size ())) ++doubles;
+	printf (" # gg bench nibble: %zu first-letter anchors, %zu pair anchors\n",
+			singles, doubles);
+	s_shift = shift;
+	s_firsts = firsts;
+	s_accept = accept;
+} // bench_nibble
+
+//MMMMMMMMMMMMMMMMMMMMMMMMMMMMMMMMMMMMMMMMMMMMMMMMMMMMMMMMMMMMMMMMMMMMMMMMMMMMMM
+//------------------------------------------------------------------------------
+/// @brief main (benchmark entrypoint)
+int
+main (int32_t a_argc, char** a_argv)
+//------------------------------------------------------------------------------
+{
+	string name{a_argc > 1 ? a_argv[1] : "all"};
+	string path{a_argc > 2 ? a_argv[2] : "/usr/include"};
+	bool all{name == "all"};
+
+	if (all || name == "open") bench_open (path);
+	if (all || name == "read") bench_read (a_argc > 2 ? path : "/tmp");
+	if (all || name == "ac") bench_ac (a_argc > 2 ? path : "data/pg10681.txt");
+	if (all || name == "anchor")
+	{
+		bench_anchor (a_argc > 2 ? path : "data/pg10681.txt");
+	}
+	if (all || name == "rare") bench_rare (a_argc > 2 ? path : "data/pg22.txt");
+	if (all || name == "shift") bench_shift (a_argc > 2 ? path : "data/pg10681.txt");
+	if (all || name == "manber") bench_manber (a_argc > 2 ? path : "data/pg22.txt");
+	if (all || name == "policy") bench_policy (a_argc > 2 ? path : "data/pg10681.txt");
+	if (all || name == "streams")
+	{
+		bench_streams (a_argc > 2 ? path : "data/pg10681.txt");
+	}
+	if (all || name == "sparse") bench_sparse (a_argc > 2 ? path : "data/pg22.txt");
+	if (all || name == "tlb") bench_tlb (a_argc > 2 ? path : "data/pg22.txt");
+	if (all || name == "image") bench_image (a_argc > 2 ? path : "data/pg22.txt");
+	// Last: the shape changes to nibbles for the rest of the process.
+	if (all || name == "nibble") bench_nibble (a_argc > 2 ? path : "data/pg10681.txt");
+	return 0;
+} // main
+//MMMMMMMMMMMMMMMMMMMMMMMMMMMMMMMMMMMMMMMMMMMMMMMMMMMMMMMMMMMMMMMMMMMMMMMMMMMMMM
@@ -0,0 +1,325 @@
+/*_____________________________________________________________________________
+            The MIT License (https://opensource.org/licenses/MIT)
+
+        Copyright (c) 2017, Jonathan D. Lettvin, All Rights Reserved.
+
+Permission is hereby granted, free of charge, to any person obtaining a copy of
+this software and associated documentation files (the "Software"), to deal in
+the Software without restriction, including without limitation the rights to
+use, copy, modify, merge, publish, distribute, sublicense, and/or sell copies
+of the Software, and to permit persons to whom the Software is furnished to do
+so, subject to the following conditions:
+
+The above copyright notice and this permission notice shall be included in all
+copies or substantial portions of the Software.
+
+THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+SOFTWARE.
+_____________________________________________________________________________*/
+
+#include <algorithm>
+#include <cerrno>
+#include <cstdio>
+#include <cstdlib>
+#include <ctime>
+#include <tuple>
+#include <vector>
+
+#include <dirent.h>
+#include <fcntl.h>                 // AT_FDCWD
+#include <sys/file.h>              // flock
+#include <sys/mman.h>              // shm_open, shm_unlink
+#include <sys/stat.h>              // mkdir, stat, utimensat
+#include <unistd.h>                // unlink
+
+#include "gg_version.h"            // s_version
+#include "gg_utility.h"            // debugf
+#include "gg_cache.h"
+
+//------------------------------------------------------------------------------
+Lettvin::QueryCache::
+QueryCache (const string& a_dir)
+//------------------------------------------------------------------------------
+	: m_dir (a_dir)
+{
+	if (m_dir.empty ())
+	{
+		if (const char* env = getenv ("GG_CACHE"))
+		{
+			m_dir = env;
+		}
+		else if (const char* xdg = getenv ("XDG_CACHE_HOME"))
+		{
+			m_dir = string (xdg) + "/gg";
+		}
+		else if (const char* home = getenv ("HOME"))
+		{
+			m_dir = string (home) + "/.cache/gg";
+		}
+	}
+	// Create each missing component; an unusable directory disables.
+	// Only this user may list or read the cached patterns.
+	for (size_t slash=m_dir.find ('/', 1); !m_dir.empty (); slash=m_dir.find ('/', slash + 1))
+	{
+		string part{m_dir.substr (0, slash)};
+		if (mkdir (part.c_str (), 0700) && errno != EEXIST)
+		{
+			debugf (1, "QUERY CACHE disabled: %s\n", part.c_str ());
+			m_dir.clear ();
+		}
+		if (slash == string::npos) break;
+	}
+} // ctor
+
+//------------------------------------------------------------------------------
+/// @brief FNV-1a of everything which changes the compiled table
+uint64_t
+Lettvin::QueryCache::
+key ()
+//------------------------------------------------------------------------------
+{
+	uint64_t hash{0xcbf29ce484222325ULL};
+	auto mix = [&hash] (const void* a_data, size_t a_bytes)
+	{
+		const uint8_t* at{static_cast<const uint8_t*> (a_data)};
+		for (size_t i=0; i < a_bytes; ++i)
+		{
+			hash = (hash ^ at[i]) * 0x100000001b3ULL;
+		}
+	};
+	auto value = [&mix] (uint64_t a_value) { mix (&a_value, sizeof (a_value)); };
+	value (s_version.major);
+	value (s_version.minor);
+	value (s_version.build);
+	value (s_caseless);
+	value (s_variant);
+	value (s_shape.nibbles ());
+	value (s_shape.sparse ());
+	value (s_budget);
+	for (auto* list:{&s_accept, &s_reject})
+	{
+		value (list->size ());
+		for (auto& str:*list)
+		{
+			value (str.size ());
+			mix (str.data (), str.size ());
+		}
+	}
+	return hash;
+} // key
+
+//------------------------------------------------------------------------------
+std::string
+Lettvin::QueryCache::
+path () const
+//------------------------------------------------------------------------------
+{
+	char name[32];
+	snprintf (name, sizeof (name), "/%016llx.table", (unsigned long long) key ());
+	return m_dir + name;
+} // path
+
+//------------------------------------------------------------------------------
+/// @brief load the current query's table into a fresh a_table
+///
+/// A hit refreshes the file's modification time, which evict treats as
+/// its last use.
+bool
+Lettvin::QueryCache::
+load (Table& a_table) const
+//------------------------------------------------------------------------------
+{
+	if (m_dir.empty ()) return false;
+	string file{path ()};
+	bool hit{a_table.load (file.c_str ())};
+	if (hit) utimensat (AT_FDCWD, file.c_str (), nullptr, 0);
+	debugf (1, "QUERY CACHE %s: %s\n", hit ? "hit" : "miss", file.c_str ());
+	return hit;
+} // load
+
+//------------------------------------------------------------------------------
+bool
+Lettvin::QueryCache::
+store (Table& a_table) const
+//------------------------------------------------------------------------------
+{
+	if (m_dir.empty ()) return false;
+	bool stored{a_table.dump (path ().c_str (), "query cache")};
+	evict ();
+	return stored;
+} // store
+
+//------------------------------------------------------------------------------
+/// @brief remove files unused for s_age, then the least recently
+/// used while all exceed s_limit bytes
+///
+/// Temporary files left by an interrupted dump age out the same way.
+void
+Lettvin::QueryCache::
+evict () const
+//------------------------------------------------------------------------------
+{
+	DIR* dir{m_dir.empty () ? nullptr : opendir (m_dir.c_str ())};
+	if (!dir) return;
+	time_t now{time (nullptr)};
+	vector<tuple<time_t, size_t, string>> files;   ///< mtime, bytes, path
+	size_t total{0};
+	while (dirent* entry = readdir (dir))
+	{
+		string name{entry->d_name};
+		if (name.find (".table") == string::npos) continue;
+		string file{m_dir + "/" + name};
+		struct stat st;
+		if (stat (file.c_str (), &st) || !S_ISREG (st.st_mode)) continue;
+		if (now - st.st_mtime > s_age)
+		{
+			unlink (file.c_str ());
+			continue;
+		}
+		files.emplace_back (st.st_mtime, size_t (st.st_size), file);
+		total += size_t (st.st_size);
+	}
+	closedir (dir);
+	sort (files.begin (), files.end ());
+	for (auto& [mtime, bytes, file]:files)
+	{
+		if (total <= s_limit) break;
+		if (!unlink (file.c_str ())) total -= bytes;
+	}
+} // evict
+
+//------------------------------------------------------------------------------
+Lettvin::SharedQuery::
+SharedQuery (time_t a_lease)
+//------------------------------------------------------------------------------
+	: m_lease (a_lease)
+{
+	char name[48];
+	snprintf (name, sizeof (name), "/gg.%u.%016llx",
+			unsigned (geteuid ()), (unsigned long long) QueryCache::key ());
+	m_name = name;
+} // ctor
+
+//------------------------------------------------------------------------------
+Lettvin::SharedQuery::
+~SharedQuery ()
+//------------------------------------------------------------------------------
+{
+	if (m_fd >= 0) close (m_fd);
+} // dtor
+
+//------------------------------------------------------------------------------
+/// @brief load the published segment into a fresh a_table
+///
+/// Only a segment this user owns is used: another user could have
+/// created the name first, and load trusts no more than the writer.
+/// Attaching renews the lease (the segment's modification time).
+/// The shared flock is kept until exit.
+bool
+Lettvin::SharedQuery::
+attach (Table& a_table)
+//------------------------------------------------------------------------------
+{
+	if (m_fd >= 0) return false;
+	int fd{shm_open (m_name.c_str (), O_RDONLY, 0)};
+	if (fd < 0) return false;
+	struct stat owner;
+	if (fstat (fd, &owner) || owner.st_uid != geteuid ())
+	{
+		close (fd);
+		debugf (1, "SHARED not ours: %s\n", m_name.c_str ());
+		return false;
+	}
+	if (flock (fd, LOCK_SH) || !a_table.load (fd, m_name.c_str ()))
+	{
+		// Empty: its publisher has not locked it yet (or died; see sweep).
+		struct stat st;
+		bool empty{fstat (fd, &st) || !st.st_size};
+		close (fd);
+		if (!empty) discard (m_name, 0);
+		debugf (1, "SHARED unusable: %s\n", m_name.c_str ());
+		return false;
+	}
+	futimens (fd, nullptr);
+	m_fd = fd;
+	debugf (1, "SHARED attached: %s\n", m_name.c_str ());
+	return true;
+} // attach
+
+//------------------------------------------------------------------------------
+/// @brief publish the sealed a_table unless another process has
+///
+/// O_EXCL makes one of several racing publishers the writer; the others
+/// keep their own tables.  After writing, the exclusive flock becomes
+/// a shared one so readers waiting in attach may load.
+/// Mode 0600 keeps the patterns from other users.
+bool
+Lettvin::SharedQuery::
+publish (Table& a_table)
+//------------------------------------------------------------------------------
+{
+	if (m_fd >= 0) return false;
+	sweep ();
+	int fd{shm_open (m_name.c_str (), O_RDWR | O_CREAT | O_EXCL, 0600)};
+	if (fd < 0) return false;
+	if (flock (fd, LOCK_EX) || !a_table.dump (fd, "shared"))
+	{
+		shm_unlink (m_name.c_str ());
+		close (fd);
+		debugf (1, "SHARED publish failed: %s\n", m_name.c_str ());
+		return false;
+	}
+	flock (fd, LOCK_SH);
+	m_fd = fd;
+	debugf (1, "SHARED published: %s\n", m_name.c_str ());
+	return true;
+} // publish
+
+//------------------------------------------------------------------------------
+/// @brief remove a_name if no process holds it and none attached
+/// for a_lease seconds
+bool
+Lettvin::SharedQuery::
+discard (const string& a_name, time_t a_lease)
+//------------------------------------------------------------------------------
+{
+	int fd{shm_open (a_name.c_str (), O_RDONLY, 0)};
+	if (fd < 0) return false;
+	struct stat st;
+	bool unused{!flock (fd, LOCK_EX | LOCK_NB) && !fstat (fd, &st) &&
+		time (nullptr) - st.st_mtime >= a_lease};
+	if (unused) shm_unlink (a_name.c_str ());
+	close (fd);
+	return unused;
+} // discard
+
+//------------------------------------------------------------------------------
+/// @brief remove this user's gg segments unused and unattached for the lease
+///
+/// POSIX cannot list shared memory; where it is /dev/shm (Linux) the
+/// gg.{uid}.{key} segments there are checked.  Elsewhere none are removed.
+void
+Lettvin::SharedQuery::
+sweep () const
+//------------------------------------------------------------------------------
+{
+	DIR* dir{opendir ("/dev/shm")};
+	if (!dir) return;
+	string mine{"gg." + to_string (geteuid ()) + "."};
+	while (dirent* entry = readdir (dir))
+	{
+		string name{entry->d_name};
+		if (name.compare (0, mine.size (), mine) ||
+				name.size () != mine.size () + 16) continue;
+		if (discard ("/" + name, m_lease))
+		{
+			debugf (1, "SHARED expired: %s\n", name.c_str ());
+		}
+	}
+	closedir (dir);
+} // sweep
@@ -0,0 +1,165 @@
+/*_____________________________________________________________________________
+            The MIT License (https://opensource.org/licenses/MIT)
+
+        Copyright (c) 2017, Jonathan D. Lettvin, All Rights Reserved.
+
+Permission is hereby granted, free of charge, to any person obtaining a copy of
+this software and associated documentation files (the "Software"), to deal in
+the Software without restriction, including without limitation the rights to
+use, copy, modify, merge, publish, distribute, sublicense, and/or sell copies
+of the Software, and to permit persons to whom the Software is furnished to do
+so, subject to the following conditions:
+
+The above copyright notice and this permission notice shall be included in all
+copies or substantial portions of the Software.
+
+THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+SOFTWARE.
+_____________________________________________________________________________*/
+
+#pragma once
+
+#include <cstdint>
+#include <ctime>
+#include <string>
+
+#include "gg_globals.h"
+#include "gg_state.h"              // Table::dump and Table::load
+
+namespace Lettvin
+{
+	using namespace std;
+
+	//CCCCCCCCCCCCCCCCCCCCCCCCCCCCCCCCCCCCCCCCCCCCCCCCCCCCCCCCCCCCCCCCCCCCCCCCCC
+	/// @brief directory of compiled tables keyed by query
+	///
+	/// A query is the accept and reject lists with every option which
+	/// changes what compile and insert produce (variants, case, shape,
+	/// budget) and the gg version.  Its table is dumped to a file named by
+	/// a hash of the query; a later identical query loads the file instead
+	/// of compiling.  Files unused for s_age or beyond s_limit bytes in all
+	/// (least recently used first) are removed whenever a table is stored.
+	//__________________________________________________________________________
+	class
+	QueryCache
+	{
+	//------
+	public:
+	//------
+		static constexpr size_t s_limit{size_t (1) << 28}; ///< bytes in all files
+		static constexpr time_t s_age  {30 * 24 * 3600};   ///< seconds unused
+
+		//----------------------------------------------------------------------
+		/// @brief cache in a_dir, else $GG_CACHE, else $XDG_CACHE_HOME/gg,
+		/// else $HOME/.cache/gg
+		QueryCache (const string& a_dir="");
+
+		//----------------------------------------------------------------------
+		/// @brief hash of the current query (globals)
+		static uint64_t
+		key ();
+
+		//----------------------------------------------------------------------
+		/// @brief file holding the current query's table
+		string
+		path () const;
+
+		//----------------------------------------------------------------------
+		/// @brief load the current query's table into a fresh a_table
+		///
+		/// @returns false on a miss (or an unusable file)
+		bool
+		load (Table& a_table) const;
+
+		//----------------------------------------------------------------------
+		/// @brief dump the sealed a_table for the current query, then evict
+		bool
+		store (Table& a_table) const;
+
+		//----------------------------------------------------------------------
+		/// @brief remove files unused for s_age, then the least recently
+		/// used while all exceed s_limit bytes
+		void
+		evict () const;
+
+		//----------------------------------------------------------------------
+		const string& directory () const { return m_dir; }
+
+	//------
+	private:
+	//------
+		string m_dir;              ///< cache directory (empty: disabled)
+	}; // class QueryCache
+
+	//CCCCCCCCCCCCCCCCCCCCCCCCCCCCCCCCCCCCCCCCCCCCCCCCCCCCCCCCCCCCCCCCCCCCCCCCCC
+	/// @brief compiled query published in POSIX shared memory
+	///
+	/// The first process to run a query publishes its image as
+	/// /gg.{uid}.{key}, mode 0600; later processes of the same user map
+	/// that read-only, so the planes are compiled and resident once.
+	/// Each user holds a shared flock on the segment until it exits (the
+	/// kernel drops it even on a crash), and a publisher holds an
+	/// exclusive one while writing.
+	/// The segment outlives its publisher: it is removed only by sweep,
+	/// when no process holds it and none attached for a_lease seconds.
+	//__________________________________________________________________________
+	class
+	SharedQuery
+	{
+	//------
+	public:
+	//------
+		//----------------------------------------------------------------------
+		/// @brief segment for the current query (globals), leased a_lease s
+		SharedQuery (time_t a_lease);
+		SharedQuery (const SharedQuery&) = delete;
+		SharedQuery& operator= (const SharedQuery&) = delete;
+
+		//----------------------------------------------------------------------
+		/// @brief release this process's hold on the segment
+		~SharedQuery ();
+
+		//----------------------------------------------------------------------
+		/// @brief load the published segment into a fresh a_table
+		///
+		/// Waits while a publisher is still writing.  A segment owned by
+		/// another user is ignored; one which does not load (its
+		/// publisher died writing) is removed.
+		/// @returns false when there is none
+		bool
+		attach (Table& a_table);
+
+		//----------------------------------------------------------------------
+		/// @brief publish the sealed a_table unless another process has
+		bool
+		publish (Table& a_table);
+
+		//----------------------------------------------------------------------
+		/// @brief remove gg segments unused and unattached for the lease
+		void
+		sweep () const;
+
+		//----------------------------------------------------------------------
+		/// @brief remove a_name if no process holds it and none attached
+		/// for a_lease seconds
+		static bool
+		discard (const string& a_name, time_t a_lease);
+
+		//----------------------------------------------------------------------
+		bool          held () const { return m_fd >= 0; }
+		const string& name () const { return m_name; }
+
+	//------
+	private:
+	//------
+
+		string m_name;             ///< shm_open name, /gg.{uid}.{key}
+		time_t m_lease;            ///< seconds kept after the last attach
+		int    m_fd{-1};           ///< held segment (shared flock)
+	}; // class SharedQuery
+}  // namespace Lettvin
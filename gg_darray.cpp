@@ -0,0 +1,210 @@
+/*_____________________________________________________________________________
+            The MIT License (https://opensource.org/licenses/MIT)
+
+        Copyright (c) 2017, Jonathan D. Lettvin, All Rights Reserved.
+
+Permission is hereby granted, free of charge, to any person obtaining a copy of
+this software and associated documentation files (the "Software"), to deal in
+the Software without restriction, including without limitation the rights to
+use, copy, modify, merge, publish, distribute, sublicense, and/or sell copies
+of the Software, and to permit persons to whom the Software is furnished to do
+so, subject to the following conditions:
+
+The above copyright notice and this permission notice shall be included in all
+copies or substantial portions of the Software.
+
+THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+SOFTWARE.
+_____________________________________________________________________________*/
+
+#include <algorithm>
+#include <cctype>
+#include <deque>
+
+#include "gg_darray.h"
+
+//------------------------------------------------------------------------------
+/// @brief edge of a_node on a_byte, created to a_shared (or a new node)
+uint32_t
+Lettvin::DoubleArray::
+child (uint32_t a_node, uint8_t a_byte, uint32_t a_shared)
+//------------------------------------------------------------------------------
+{
+	auto& edges{m_nodes[a_node].m_edges};
+	auto edge{lower_bound (edges.begin (), edges.end (),
+			make_pair (a_byte, uint32_t (0)))};
+	if (edge != edges.end () && edge->first == a_byte) return edge->second;
+	uint32_t node{a_shared};
+	if (!node)
+	{
+		node = static_cast<uint32_t> (m_nodes.size ());
+		m_nodes.emplace_back ();
+	}
+	// m_nodes may have moved: look the edge list up again.
+	auto& grown{m_nodes[a_node].m_edges};
+	grown.insert (lower_bound (grown.begin (), grown.end (),
+				make_pair (a_byte, uint32_t (0))), make_pair (a_byte, node));
+	return node;
+} // child
+
+//------------------------------------------------------------------------------
+/// @brief add a string ending in group a_grp (last insert wins)
+///
+/// Caseless letters lead to one node by both cases, as in the planes.
+void
+Lettvin::DoubleArray::
+insert (string_view a_str, bool a_caseless, i24_t a_grp)
+//------------------------------------------------------------------------------
+{
+	uint32_t node{0};
+	for (char c:a_str)
+	{
+		uint8_t byte{static_cast<uint8_t> (c)};
+		if (!a_caseless || toupper (byte) == tolower (byte))
+		{
+			node = child (node, byte, 0);
+			continue;
+		}
+		uint32_t next{child (node, static_cast<uint8_t> (toupper (byte)), 0)};
+		node = child (node, static_cast<uint8_t> (tolower (byte)), next);
+	}
+	m_nodes[node].m_grp = a_grp;
+} // insert
+
+//------------------------------------------------------------------------------
+/// @brief pack the inserted strings into base/check cells
+///
+/// Breadth-first, each state takes the lowest base at which every one of
+/// its edge slots is free (first-fit over a list of free cells).
+/// A node reached by both cases of a letter is placed at its first edge;
+/// the other edge's slot becomes an alias, completed once bases are known.
+/// 256 spare cells at the end let next () index without a bounds test.
+void
+Lettvin::DoubleArray::
+build ()
+//------------------------------------------------------------------------------
+{
+	m_cells.clear ();
+	vector<uint32_t> slot (m_nodes.size (), 0);
+	vector<pair<uint32_t, uint32_t>> aliases;  // slot, node
+	slot[0] = s_root;
+	m_states = 1;
+
+	// Free cells form a list in address order; first-fit walks only them.
+	vector<uint32_t> after (m_cells.size ()), before (m_cells.size ());
+	uint32_t head{0};                            // 0: empty list
+	auto grow = [&] (size_t a_size)
+	{
+		size_t old{m_cells.size ()};
+		m_cells.resize (a_size);
+		after.resize (a_size);
+		before.resize (a_size);
+		uint32_t tail{head ? before[head] : 0};
+		for (size_t cell=max (old, size_t (s_root + 1)); cell < a_size; ++cell)
+		{
+			uint32_t at{static_cast<uint32_t> (cell)};
+			if (!head)
+			{
+				head = after[at] = before[at] = at;
+			}
+			else
+			{
+				after[tail] = at;
+				before[at]  = tail;
+				after[at]   = head;
+				before[head]= at;
+			}
+			tail = at;
+		}
+	};
+	auto take = [&] (uint32_t a_cell)
+	{
+		if (after[a_cell] == a_cell)
+		{
+			head = 0;
+			return;
+		}
+		after[before[a_cell]] = after[a_cell];
+		before[after[a_cell]] = before[a_cell];
+		if (head == a_cell) head = after[a_cell];
+	};
+	grow (s_root + 1 + 256);
+	m_cells[s_root].m_check = ~uint32_t (0);   // occupied, owned by none
+	m_cells[s_root].m_self  = s_root;
+
+	deque<uint32_t> queue{0};
+	while (!queue.empty ())
+	{
+		uint32_t node{queue.front ()};
+		queue.pop_front ();
+		uint32_t at{slot[node]};
+		m_cells[at].m_grp = m_nodes[node].m_grp;
+		auto& edges{m_nodes[node].m_edges};
+		if (edges.empty ()) continue;
+
+		uint8_t first{edges.front ().first};
+		auto fits = [&] (size_t a_base)
+		{
+			if (a_base + 256 + 1 > m_cells.size ())
+			{
+				grow (max (m_cells.size () * 2, a_base + 256 + 1));
+			}
+			for (auto& [byte, child]:edges)
+			{
+				if (m_cells[a_base + byte].m_check) return false;
+			}
+			return true;
+		};
+		// Try each free cell for the first edge; past the list's end,
+		// the array grows and its new cells are all free.
+		size_t base{0};
+		for (uint32_t cell=head; ; cell=after[cell])
+		{
+			if (cell > first && fits (size_t (cell) - first))
+			{
+				base = cell - first;
+				break;
+			}
+			if (!cell || after[cell] == head)
+			{
+				base = max (m_cells.size (), size_t (first) + 1) - first;
+				fits (base);
+				break;
+			}
+		}
+		m_cells[at].m_base = static_cast<uint32_t> (base);
+		for (auto& [byte, child]:edges)
+		{
+			uint32_t cell{static_cast<uint32_t> (base + byte)};
+			m_cells[cell].m_check = at;
+			take (cell);
+			if (slot[child])
+			{
+				aliases.emplace_back (cell, child);
+				continue;
+			}
+			slot[child] = cell;
+			m_cells[cell].m_self = cell;
+			queue.push_back (child);
+			++m_states;
+		}
+	}
+	for (auto& [cell, node]:aliases)
+	{
+		const Cell& state{m_cells[slot[node]]};
+		m_cells[cell].m_base = state.m_base;
+		m_cells[cell].m_self = state.m_self;
+		m_cells[cell].m_grp  = state.m_grp;
+	}
+	// Trim to the last used cell plus the 256 spare.
+	size_t used{m_cells.size ()};
+	while (used > s_root + 1 && !m_cells[used - 1].m_check) --used;
+	m_cells.resize (used + 256);
+	m_cells.shrink_to_fit ();
+	vector<Node> ().swap (m_nodes);
+} // build
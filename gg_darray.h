@@ -0,0 +1,115 @@
+/*_____________________________________________________________________________
+            The MIT License (https://opensource.org/licenses/MIT)
+
+        Copyright (c) 2017, Jonathan D. Lettvin, All Rights Reserved.
+
+Permission is hereby granted, free of charge, to any person obtaining a copy of
+this software and associated documentation files (the "Software"), to deal in
+the Software without restriction, including without limitation the rights to
+use, copy, modify, merge, publish, distribute, sublicense, and/or sell copies
+of the Software, and to permit persons to whom the Software is furnished to do
+so, subject to the following conditions:
+
+The above copyright notice and this permission notice shall be included in all
+copies or substantial portions of the Software.
+
+THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+SOFTWARE.
+_____________________________________________________________________________*/
+
+#pragma once
+
+#include <cstdint>
+#include <string>
+#include <vector>
+#include <utility>
+#include <string_view>
+
+#include "gg_globals.h"
+
+namespace Lettvin
+{
+	using namespace std;
+
+	//CCCCCCCCCCCCCCCCCCCCCCCCCCCCCCCCCCCCCCCCCCCCCCCCCCCCCCCCCCCCCCCCCCCCCCCCCC
+	/// @brief double-array trie: transitions in memory per real edge
+	///
+	/// Dense planes cost 256 Transitions per state whether or not the
+	/// edges exist.  Here the state is a slot; its edge on byte c leads to
+	/// slot base+c, which belongs to it only when that slot's check names
+	/// it.  A transition is one add, two loads and one compare.
+	/// Bases are packed first-fit so slots are mostly occupied.
+	/// Strings are collected in a temporary edge-list trie by insert and
+	/// packed by build, which frees the temporary trie.
+	//__________________________________________________________________________
+	class
+	DoubleArray
+	{
+	//------
+	public:
+	//------
+		static constexpr uint32_t s_root{1};
+
+		//----------------------------------------------------------------------
+		/// @brief add a string ending in group a_grp (last insert wins)
+		void insert (string_view a_str, bool a_caseless, i24_t a_grp);
+
+		//----------------------------------------------------------------------
+		/// @brief pack the inserted strings into base/check cells
+		void build ();
+
+		//----------------------------------------------------------------------
+		/// @brief slot reached from a_slot on a_byte, or 0 for none
+		uint32_t next (uint32_t a_slot, uint8_t a_byte) const
+		{
+			const Cell& from{m_cells[a_slot]};
+			uint32_t slot{from.m_base + a_byte};
+			return m_cells[slot].m_check == from.m_self ? slot : 0;
+		}
+
+		//----------------------------------------------------------------------
+		/// @brief group of strings ending at a_slot (0 for none)
+		i24_t grp (uint32_t a_slot) const { return m_cells[a_slot].m_grp; }
+
+		//----------------------------------------------------------------------
+		size_t states () const { return m_states; }
+		size_t bytes  () const { return m_cells.size () * sizeof (Cell); }
+
+	//------
+	private:
+	//------
+		//----------------------------------------------------------------------
+		/// @brief one slot; m_check is the owning state (0 when free)
+		///
+		/// Both cases of a caseless letter lead to one state, but each
+		/// edge needs its own slot: the second is an alias whose m_self
+		/// (and base and group) are the state's.
+		struct Cell
+		{
+			uint32_t m_base {0};
+			uint32_t m_check{0};
+			uint32_t m_self {0};
+			i24_t    m_grp  {0};
+		};
+
+		//----------------------------------------------------------------------
+		/// @brief temporary trie node: sorted edges and terminal group
+		struct Node
+		{
+			vector<pair<uint8_t, uint32_t>> m_edges;
+			i24_t                           m_grp{0};
+		};
+
+		//----------------------------------------------------------------------
+		uint32_t child (uint32_t a_node, uint8_t a_byte, uint32_t a_shared);
+
+		vector<Node> m_nodes{Node{}};   ///< temporary, root is node 0
+		vector<Cell> m_cells;           ///< packed slots
+		size_t       m_states{0};       ///< slots in use
+	}; // class DoubleArray
+} // namespace Lettvin
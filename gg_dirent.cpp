@@ -0,0 +1,236 @@
+/*_____________________________________________________________________________
+            The MIT License (https://opensource.org/licenses/MIT)
+
+        Copyright (c) 2017, Jonathan D. Lettvin, All Rights Reserved.
+
+Permission is hereby granted, free of charge, to any person obtaining a copy of
+this software and associated documentation files (the "Software"), to deal in
+the Software without restriction, including without limitation the rights to
+use, copy, modify, merge, publish, distribute, sublicense, and/or sell copies
+of the Software, and to permit persons to whom the Software is furnished to do
+so, subject to the following conditions:
+
+The above copyright notice and this permission notice shall be included in all
+copies or substantial portions of the Software.
+
+THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+SOFTWARE.
+_____________________________________________________________________________*/
+
+#include <sys/syscall.h>           // SYS_getdents64
+#include <sys/stat.h>              // fstatat
+#include <fcntl.h>                 // O_DIRECTORY
+#include <unistd.h>                // syscall, close
+#include <errno.h>
+
+#include <cstdlib>                 // aligned_alloc
+
+#include <cstring>                 // strlen
+
+#include "gg_dirent.h"
+
+namespace
+{
+	/// Layout returned by getdents64 (not exported by all libc headers).
+	struct linux_dirent64
+	{
+		uint64_t       d_ino;
+		int64_t        d_off;
+		unsigned short d_reclen;
+		unsigned char  d_type;
+		char           d_name[];
+	};
+
+	/// Readers never nest within a thread so one buffer per thread suffices.
+	thread_local char* t_buffer{nullptr};
+}
+
+//------------------------------------------------------------------------------
+Lettvin::DirReader::
+DirReader (const char* a_path, int32_t a_at)
+//------------------------------------------------------------------------------
+{
+	m_fd  = openat (a_at, a_path, O_RDONLY | O_DIRECTORY | O_CLOEXEC);
+	m_err = m_fd < 0 ? errno : 0;
+	if (m_fd >= 0)
+	{
+		if (!t_buffer)
+		{
+			t_buffer = static_cast<char*> (aligned_alloc (4096, s_buffer));
+		}
+		m_buf = t_buffer;
+	}
+} // ctor
+
+//------------------------------------------------------------------------------
+Lettvin::DirReader::
+~DirReader ()
+//------------------------------------------------------------------------------
+{
+	if (m_fd >= 0) close (m_fd);
+} // dtor
+
+//------------------------------------------------------------------------------
+bool
+Lettvin::DirReader::
+next (const char*& a_name, uint8_t& a_type)
+//------------------------------------------------------------------------------
+{
+	while (m_fd >= 0)
+	{
+		if (m_pos >= m_len)
+		{
+			long got = syscall (SYS_getdents64, m_fd, m_buf, s_buffer);
+			if (got <= 0)
+			{
+				m_err = got < 0 ? errno : 0;
+				return false;
+			}
+			m_len = size_t (got);
+			m_pos = 0;
+		}
+		auto entry{reinterpret_cast<linux_dirent64*> (m_buf + m_pos)};
+		m_pos += entry->d_reclen;
+
+		const char* q{entry->d_name};
+		if (*q++ == '.' && (!*q || (*q++ == '.' && !*q))) continue;
+
+		a_name = entry->d_name;
+		a_type = classify (m_fd, a_name, entry->d_type);
+		return true;
+	}
+	return false;
+} // next
+
+//------------------------------------------------------------------------------
+uint8_t
+Lettvin::DirReader::
+classify (int32_t a_at, const char* a_name, uint8_t a_type)
+//------------------------------------------------------------------------------
+{
+	if (a_type != DT_UNKNOWN && a_type != DT_LNK)
+	{
+		return a_type;
+	}
+	struct stat st;
+	if (fstatat (a_at, a_name, &st, 0))
+	{
+		return DT_UNKNOWN;
+	}
+	return
+		S_ISDIR (st.st_mode) ? DT_DIR :
+		S_ISREG (st.st_mode) ? DT_REG :
+		DT_UNKNOWN;
+} // classify
+
+//DDDDDDDDDDDDDDDDDDDDDDDDDDDDDDDDDDDDDDDDDDDDDDDDDDDDDDDDDDDDDDDDDDDDDDDDDDDDDD
+
+//------------------------------------------------------------------------------
+Lettvin::Directory::
+Directory (Directory* a_parent, const char* a_name)
+//------------------------------------------------------------------------------
+	: m_parent (a_parent)
+	, m_name (a_name)
+{
+	if (m_parent) m_parent->retain ();
+} // ctor
+
+//------------------------------------------------------------------------------
+Lettvin::Directory::
+~Directory ()
+//------------------------------------------------------------------------------
+{
+	if (m_fd >= 0)
+	{
+		close (m_fd);
+		if (m_fds) m_fds->release ();
+	}
+	if (m_parent) m_parent->release ();
+} // dtor
+
+//------------------------------------------------------------------------------
+void
+Lettvin::Directory::
+retain ()
+//------------------------------------------------------------------------------
+{
+	m_refs.fetch_add (1, std::memory_order_relaxed);
+} // retain
+
+//------------------------------------------------------------------------------
+void
+Lettvin::Directory::
+release ()
+//------------------------------------------------------------------------------
+{
+	if (m_refs.fetch_sub (1, std::memory_order_acq_rel) == 1)
+	{
+		delete this;
+	}
+} // release
+
+//------------------------------------------------------------------------------
+void
+Lettvin::Directory::
+adopt (int32_t a_fd, FdBudget& a_fds)
+//------------------------------------------------------------------------------
+{
+	if (a_fd >= 0 && a_fds.try_acquire (a_fds.limit () / 2))
+	{
+		m_fd  = a_fd;
+		m_fds = &a_fds;
+	}
+	else if (a_fd >= 0)
+	{
+		close (a_fd);
+	}
+} // adopt
+
+//------------------------------------------------------------------------------
+size_t
+Lettvin::Directory::
+add (const char* a_name)
+//------------------------------------------------------------------------------
+{
+	size_t offset{m_names.size ()};
+	m_names.append (a_name, strlen (a_name) + 1);
+	return offset;
+} // add
+
+//------------------------------------------------------------------------------
+void
+Lettvin::Directory::
+path (string& a_out, const char* a_name) const
+//------------------------------------------------------------------------------
+{
+	if (m_parent)
+	{
+		m_parent->path (a_out, m_name);
+	}
+	else
+	{
+		a_out.assign (m_name);
+	}
+	if (a_out.empty () || a_out.back () != '/') a_out += '/';   ///< root "/"
+	a_out += a_name;
+} // path
+
+//------------------------------------------------------------------------------
+int32_t
+Lettvin::Directory::
+at (const char*& a_name, string& a_scratch) const
+//------------------------------------------------------------------------------
+{
+	if (m_fd >= 0)
+	{
+		return m_fd;
+	}
+	path (a_scratch, a_name);
+	a_name = a_scratch.c_str ();
+	return AT_FDCWD;
+} // at
@@ -0,0 +1,167 @@
+/*_____________________________________________________________________________
+            The MIT License (https://opensource.org/licenses/MIT)
+
+        Copyright (c) 2017, Jonathan D. Lettvin, All Rights Reserved.
+
+Permission is hereby granted, free of charge, to any person obtaining a copy of
+this software and associated documentation files (the "Software"), to deal in
+the Software without restriction, including without limitation the rights to
+use, copy, modify, merge, publish, distribute, sublicense, and/or sell copies
+of the Software, and to permit persons to whom the Software is furnished to do
+so, subject to the following conditions:
+
+The above copyright notice and this permission notice shall be included in all
+copies or substantial portions of the Software.
+
+THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+SOFTWARE.
+_____________________________________________________________________________*/
+
+#pragma once
+
+#include <dirent.h>                // DT_DIR, DT_REG, DT_UNKNOWN
+#include <fcntl.h>                 // AT_FDCWD
+
+#include <cstdint>
+#include <string>
+#include <atomic>
+
+#include "gg_globals.h"
+#include "gg_utility.h"            // FdBudget
+
+namespace Lettvin
+{
+	using namespace std;
+
+	//CCCCCCCCCCCCCCCCCCCCCCCCCCCCCCCCCCCCCCCCCCCCCCCCCCCCCCCCCCCCCCCCCCCCCCCCCC
+	/// @brief bulk directory reader using getdents64 and d_type
+	///
+	/// One getdents64 call fills a large per-thread buffer with many entries.
+	/// d_type classifies most entries without a stat.
+	/// Only DT_UNKNOWN (some filesystems) and DT_LNK (follow like opendir
+	/// and open would) cost an fstatat relative to the directory descriptor.
+	//__________________________________________________________________________
+	class
+	DirReader
+	{
+	//------
+	public:
+	//------
+		//----------------------------------------------------------------------
+		/// @brief open a directory (O_DIRECTORY) relative to a_at
+		DirReader (const char* a_path, int32_t a_at=AT_FDCWD);
+
+		//----------------------------------------------------------------------
+		~DirReader ();
+
+		//----------------------------------------------------------------------
+		int32_t fd      () const { return m_fd; }
+		bool    is_open () const { return m_fd >= 0; }
+		int32_t error   () const { return m_err; }
+
+		//----------------------------------------------------------------------
+		/// @brief next entry other than "." and ".." classified as
+		/// DT_DIR, DT_REG or another DT_ value.
+		///
+		/// a_name remains valid until the next call.
+		/// @returns false when the directory is exhausted.
+		bool next (const char*& a_name, uint8_t& a_type);
+
+		//----------------------------------------------------------------------
+		/// @brief give up ownership of the directory descriptor
+		int32_t detach () { int32_t fd{m_fd}; m_fd = -1; return fd; }
+
+		//----------------------------------------------------------------------
+		/// @brief resolve DT_UNKNOWN and DT_LNK with fstatat
+		static uint8_t classify (int32_t a_at, const char* a_name, uint8_t a_type);
+
+		static const size_t s_buffer{1 << 16};   ///< getdents64 buffer bytes
+
+	//------
+	private:
+	//------
+		int32_t m_fd  {-1};
+		int32_t m_err {0};
+		char*   m_buf {nullptr};
+		size_t  m_pos {0};
+		size_t  m_len {0};
+	}; // class DirReader
+
+	//CCCCCCCCCCCCCCCCCCCCCCCCCCCCCCCCCCCCCCCCCCCCCCCCCCCCCCCCCCCCCCCCCCCCCCCCCC
+	/// @brief reference-counted directory node for relative traversal
+	///
+	/// A Directory keeps its descriptor open while entries remain to be
+	/// handled so that children are opened with openat relative to it
+	/// instead of resolving a full path in the kernel for every entry.
+	/// Entry names are stored once in m_names, an arena filled completely
+	/// before any name is handed out, so each entry costs no allocation.
+	/// Full paths are materialized only on demand (a match or an error).
+	/// Every Entry (and Mapped file) holds one reference; a Directory
+	/// holds one reference on its parent, which keeps its own name alive.
+	//__________________________________________________________________________
+	class
+	Directory
+	{
+	//------
+	public:
+	//------
+		//----------------------------------------------------------------------
+		/// @brief a_name must outlive the node (parent arena or root string)
+		Directory (Directory* a_parent, const char* a_name);
+
+		//----------------------------------------------------------------------
+		void retain  ();
+		void release ();
+
+		//----------------------------------------------------------------------
+		/// @brief descriptor for openat or -1 when not kept (use path)
+		int32_t fd () const { return m_fd; }
+
+		//----------------------------------------------------------------------
+		/// @brief keep a_fd open if the budget permits, else close it.
+		///
+		/// Directories may hold at most half of the budget so that
+		/// file opens always make progress.
+		void adopt (int32_t a_fd, FdBudget& a_fds);
+
+		//----------------------------------------------------------------------
+		/// @brief append a name to the arena
+		/// @returns offset of the name for use once the arena is complete
+		size_t add (const char* a_name);
+
+		//----------------------------------------------------------------------
+		/// @brief name stored at a_offset (stable once adding is complete)
+		const char* name (size_t a_offset) const
+		{
+			return m_names.data () + a_offset;
+		}
+
+		//----------------------------------------------------------------------
+		/// @brief materialize the path of a_name in this directory
+		void path (string& a_out, const char* a_name) const;
+
+		//----------------------------------------------------------------------
+		/// @brief descriptor and name suitable for openat of a_name
+		///
+		/// Uses fd () when kept, otherwise a_scratch receives the full path.
+		int32_t at (const char*& a_name, string& a_scratch) const;
+
+	//------
+	private:
+	//------
+		~Directory ();
+
+		Directory*     m_parent{nullptr};
+		const char*    m_name  {nullptr};
+		int32_t        m_fd    {-1};
+		FdBudget*      m_fds   {nullptr};   ///< set when m_fd is budgeted
+		atomic<size_t> m_refs  {1};
+		string         m_names;             ///< arena of entry names
+	}; // class Directory
+
+}  // namespace Lettvin
@@ -38,16 +38,64 @@ namespace Lettvin
 	bool        s_variant  {false};     ///< enable variant syntax
 
 	bool        s_quicktree{false};     ///< just show the filenames
+	bool        s_querycache{true};     ///< see gg_cache.h
+	size_t      s_lease    {0};         ///< --shared seconds, see gg_cache.h
 
-	uint8_t     s_root     {1};         ///< syntax tree root plane number
+	state_t     s_root     {1};         ///< syntax tree root plane number
 
 	Shape       s_shape;
 
 	uint32_t s_oversize{1};
+	size_t   s_pread   {1 << 16};       ///< see gg_bench read for this choice
+	size_t   s_window  {1 << 21};       ///< MADV_WILLNEED window for mmap
+	size_t   s_chunk   {1 << 26};       ///< split files of twice this size
+	size_t   s_streams {1};             ///< see gg_bench streams
+	size_t   s_shift   {128};           ///< see gg_bench shift
+	size_t   s_manber  {64};            ///< see gg_bench manber
+	size_t   s_budget  {size_t (1) << 30}; ///< see gg_bench sparse
+	size_t   s_huge    {1 << 21};       ///< see gg_bench tlb
 
 	double   s_overhead;                ///< interval for noop
 
 	string   s_firsts;                  ///< string of {arg} first letters
+	string   s_cachedir;                ///< empty: $GG_CACHE or ~/.cache/gg
+
+	/// Bytes per million of English prose and C/C++ source in equal parts.
+	/// Used to anchor on the rarest byte of each string (--frequency=FILE).
+	array<uint32_t, 256> s_frequency {{
+		     1,      1,      1,      1,      1,      1,      1,      1,  // 00
+		     1,   2453,  35988,      1,      1,  26285,      1,      1,  // 08
+		     1,      1,      1,      1,      1,      1,      1,      1,  // 10
+		     1,      1,      1,      1,      1,      1,      1,      1,  // 18
+		224349,     93,    212,   4302,      4,      3,    115,    265,  // 20
+		  3950,   3949,   6598,     16,   6490,    487,    657,   2247,  // 28
+		  8080,   6494,   6692,   5780,   6383,   5620,   6085,   5304,  // 30
+		  7395,   5565,     76,   3050,     74,     83,     52,     19,  // 38
+		     1,  10674,   3085,   5286,   3546,  13049,   4221,  16974,  // 40
+		  1414,   8647,    108,    672,  17843,   3521,   8318,   5586,  // 48
+		  9967,    207,  10743,   4924,  10177,   2763,   2463,    763,  // 50
+		  4060,   3174,    204,     82,     70,     82,      5,  13981,  // 58
+		     1,  28155,   6065,  15813,  20066,  57646,  14120,   9349,  // 60
+		  7780,  42841,    677,   1910,  17540,  12475,  39466,  29828,  // 68
+		 12280,    693,  26590,  24127,  38949,  15945,   7207,   2800,  // 70
+		  5627,   8281,   1773,     76,     16,     76,      1,      1,  // 78
+		     1,      1,      1,      1,      1,      1,      1,      1,  // 80
+		     1,      1,      1,      1,      1,      1,      1,      1,  // 88
+		     1,      1,      1,      1,      1,      1,      1,      1,  // 90
+		     1,      1,      1,      1,      1,      1,      1,      1,  // 98
+		     1,      1,      1,      1,      1,      1,      1,      1,  // a0
+		     1,      1,      1,      1,      1,      1,      1,      1,  // a8
+		     1,      1,      1,      1,      1,      1,      1,      1,  // b0
+		     1,      1,      1,      1,      1,      1,      1,      1,  // b8
+		     1,      1,      1,      1,      1,      1,      1,      1,  // c0
+		     1,      1,      1,      1,      1,      1,      1,      1,  // c8
+		     1,      1,      1,      1,      1,      1,      1,      1,  // d0
+		     1,      1,      1,      1,      1,      1,      1,      1,  // d8
+		     1,      1,      1,      1,      1,      1,      1,      1,  // e0
+		     1,      1,      1,      1,      1,      1,      1,      1,  // e8
+		     1,      1,      1,      1,      1,      1,      1,      1,  // f0
+		     1,      1,      1,      1,      1,      1,      1,      1,  // f8
+	}};
 	string   s_target;
 
 	vector<regex>           s_regex;         ///< filename match regexes
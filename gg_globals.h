@@ -30,6 +30,7 @@ _____________________________________________________________________________*/
 #define SIZED_TYPEDEF(o,n,s) typedef o n; static_assert (sizeof (o) == s)
 
 #include <cstdint>
+#include <array>
 #include <vector>
 #include <string>
 #include <set>
@@ -43,7 +44,8 @@ namespace Lettvin
 
 	//__________________________________________________________________________
 	SIZED_TYPEDEF(int32_t , i24_t     ,4);
-	SIZED_TYPEDEF(unsigned, integral_t,4);
+	SIZED_TYPEDEF(uint64_t, integral_t,8);
+	SIZED_TYPEDEF(uint32_t, state_t   ,4);
 
 	typedef vector<string>      vs_t;
 	typedef vector<string_view> vsv_t;
@@ -71,17 +73,20 @@ namespace Lettvin
 
 		//----------------------------------------------------------------------
 		bool   nibbles () { return m_nibbles; }
+		bool   sparse  () { return m_sparse ; }
 		size_t size    () { return m_size   ; }
 		size_t mask    () { return m_mask   ; }
 		size_t prefill () { return m_prefill; }
 
 		//----------------------------------------------------------------------
-		void operator()(bool nibbles=false)
+		/// Sparse shape (double-array trie) keeps byte planes for root only.
+		void operator()(bool nibbles=false, bool sparse=false)
 		{
 			assert (!m_used);
 			//assertf (!m_used, 1, "Shape change must occur before first use\n");
 			m_used = true;
 			m_nibbles = nibbles;
+			m_sparse  = sparse && !nibbles;
 			m_size    = m_nibbles ? 16 : 256;
 			m_mask    = m_size - 1;
 			m_prefill = 1 + (size_t)nibbles;
@@ -92,6 +97,7 @@ namespace Lettvin
 	//------
 		bool   m_used    {false};      ///< can be changed before first use
 		bool   m_nibbles {false};      ///< nibble planes replace bute planes
+		bool   m_sparse  {false};      ///< double-array trie replaces planes
 		size_t m_size    {256};        ///< size of a state plane
 		size_t m_mask    {m_size - 1}; ///< mask used for splitting chars
 		size_t m_prefill {1};          ///< make initial state tables
@@ -115,16 +121,28 @@ namespace Lettvin
 	extern bool        s_test     ;      ///< run unit and timing tests
 	extern bool        s_variant  ;      ///< enable variant syntax
 	extern bool        s_quicktree;     ///< just show the filenames
+	extern bool        s_querycache;    ///< load and store compiled queries
+	extern size_t      s_lease    ;      ///< shared-memory table lease (0: off)
 
-	extern uint8_t     s_root     ;      ///< syntax tree root plane number
+	extern state_t     s_root     ;      ///< syntax tree root plane number
 
 	extern Shape       s_shape    ;
 
 	extern uint32_t    s_oversize ;
+	extern size_t      s_pread    ;      ///< pread files smaller than this
+	extern size_t      s_window   ;      ///< MADV_WILLNEED window for mmap
+	extern size_t      s_chunk    ;      ///< split files of twice this size
+	extern size_t      s_streams  ;      ///< interleaved scan streams
+	extern size_t      s_shift    ;      ///< Shift-And for up to this many bytes
+	extern size_t      s_manber   ;      ///< Wu-Manber for this many strings
+	extern size_t      s_budget   ;      ///< dense planes bytes before sparse
+	extern size_t      s_huge     ;      ///< MADV_HUGEPAGE tables this large
 
 	extern double      s_overhead ;      ///< interval for noop
 
 	extern string      s_firsts   ;      ///< string of {arg} first letters
+	extern string      s_cachedir ;      ///< query cache directory (--query-cache=)
+	extern array<uint32_t, 256> s_frequency; ///< bytes per million
 	extern string      s_target   ;
 	extern const char* s_path     ;
 
@@ -0,0 +1,114 @@
+/*_____________________________________________________________________________
+            The MIT License (https://opensource.org/licenses/MIT)
+
+        Copyright (c) 2017, Jonathan D. Lettvin, All Rights Reserved.
+
+Permission is hereby granted, free of charge, to any person obtaining a copy of
+this software and associated documentation files (the "Software"), to deal in
+the Software without restriction, including without limitation the rights to
+use, copy, modify, merge, publish, distribute, sublicense, and/or sell copies
+of the Software, and to permit persons to whom the Software is furnished to do
+so, subject to the following conditions:
+
+The above copyright notice and this permission notice shall be included in all
+copies or substantial portions of the Software.
+
+THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+SOFTWARE.
+_____________________________________________________________________________*/
+
+#pragma once
+
+#include <cstdint>
+#include <array>
+#include <vector>
+#include <string_view>
+
+#include "gg_globals.h"
+
+namespace Lettvin
+{
+	using namespace std;
+
+	//CCCCCCCCCCCCCCCCCCCCCCCCCCCCCCCCCCCCCCCCCCCCCCCCCCCCCCCCCCCCCCCCCCCCCCCCCC
+	/// @brief bit-parallel (Shift-And) matcher for a few short strings
+	///
+	/// All strings are laid end to end in one W-bit word, one bit per byte.
+	/// Bit j of the state is set when the text just read ends with the first
+	/// j+1 bytes of the string owning bit j.  Each byte costs one shift,
+	/// one OR and one AND of a 256-entry mask table: no planes, no branches.
+	/// (Shift-Or is the same algorithm with every bit inverted.)
+	/// W is uint64_t or unsigned __int128.
+	//__________________________________________________________________________
+	template<typename W>
+	class
+	ShiftAnd
+	{
+	//------
+	public:
+	//------
+		static constexpr size_t bits{8 * sizeof (W)};
+
+		//----------------------------------------------------------------------
+		/// @brief add a string ending in group a_grp; false when full
+		bool insert (string_view a_str, bool a_caseless, i24_t a_grp)
+		{
+			if (a_str.empty () || m_used + a_str.size () > bits) return false;
+			m_init |= W (1) << m_used;
+			for (char c:a_str)
+			{
+				W bit{W (1) << m_used++};
+				uint8_t byte{static_cast<uint8_t> (c)};
+				m_mask[byte] |= bit;
+				if (a_caseless)
+				{
+					m_mask[static_cast<uint8_t> (toupper (byte))] |= bit;
+					m_mask[static_cast<uint8_t> (tolower (byte))] |= bit;
+				}
+			}
+			m_final |= W (1) << (m_used - 1);
+			m_grp.resize (m_used);
+			m_grp[m_used - 1] = a_grp;
+			return true;
+		}
+
+		//----------------------------------------------------------------------
+		/// @brief advance the state over one byte
+		W step (W a_state, uint8_t a_byte) const
+		{
+			return ((a_state << 1) | m_init) & m_mask[a_byte];
+		}
+
+		//----------------------------------------------------------------------
+		/// @brief strings ending here (zero when none)
+		W final (W a_state) const { return a_state & m_final; }
+
+		//----------------------------------------------------------------------
+		/// @brief call a_fun (grp) for each string ending in a_final
+		template<typename F>
+		void each (W a_final, F a_fun) const
+		{
+			for (size_t bit=0; a_final; ++bit, a_final >>= 1)
+			{
+				if (a_final & 1) a_fun (m_grp[bit]);
+			}
+		}
+
+		//----------------------------------------------------------------------
+		size_t used () const { return m_used; }
+
+	//------
+	private:
+	//------
+		array<W, 256> m_mask {};       ///< bits of strings having this byte
+		W             m_init {0};      ///< first bit of each string
+		W             m_final{0};      ///< last bit of each string
+		size_t        m_used {0};      ///< bits in use
+		vector<i24_t> m_grp;           ///< group by last bit
+	}; // class ShiftAnd
+} // namespace Lettvin
@@ -23,6 +23,15 @@ SOFTWARE.
 _____________________________________________________________________________*/
 
 #include <iomanip>
+#include <queue>
+#include <map>
+#include <unordered_map>
+#include <cstdlib>                 // mkstemp
+
+#include <sys/mman.h>              // madvise
+#include <fcntl.h>                 // open
+#include <sys/stat.h>              // fstat
+#include <unistd.h>                // pwrite, ftruncate
 
 #include "gg_state.h"
 #include "gg.h"
@@ -42,7 +51,7 @@ integral () const
 } // integral
 
 //------------------------------------------------------------------------------
-uint8_t
+Lettvin::state_t
 Lettvin::Transition::
 nxt () const
 //------------------------------------------------------------------------------
@@ -62,12 +71,30 @@ grp () const
 //------------------------------------------------------------------------------
 void
 Lettvin::Transition::
-nxt (uint8_t a_nxt)
+nxt (state_t a_nxt)
 //------------------------------------------------------------------------------
 {
 	m_the.state.nxt = a_nxt;
 } // nxt
 
+//------------------------------------------------------------------------------
+bool
+Lettvin::Transition::
+tail () const
+//------------------------------------------------------------------------------
+{
+	return m_the.state.tail;
+} // tail
+
+//------------------------------------------------------------------------------
+void
+Lettvin::Transition::
+tail (bool a_tail)
+//------------------------------------------------------------------------------
+{
+	m_the.state.tail = a_tail;
+} // tail
+
 //------------------------------------------------------------------------------
 void
 Lettvin::Transition::
@@ -83,21 +110,41 @@ grp (i24_t a_grp)
 Lettvin::State::
 State ()
 //------------------------------------------------------------------------------
-	: m_handle (s_shape.size ())
+	: m_owned (s_shape.size ())
+	, m_handle (m_owned.data ())
 {
 } // State
 
+//------------------------------------------------------------------------------
+Lettvin::State::
+State (Transition* a_plane, const uint8_t* a_classes)
+//------------------------------------------------------------------------------
+	: m_handle (a_plane)
+	, m_classes (a_classes)
+{
+} // State (plane)
+
+//------------------------------------------------------------------------------
+Lettvin::State::
+State (const State& a_other)
+//------------------------------------------------------------------------------
+	: m_owned (a_other.m_owned)
+	, m_handle (m_owned.empty () ? a_other.m_handle : m_owned.data ())
+	, m_classes (a_other.m_classes)
+{
+} // State (copy)
+
 //------------------------------------------------------------------------------
 Lettvin::Transition&
 Lettvin::State::
 operator[] (uint8_t a_off)
 //------------------------------------------------------------------------------
 {
-	return m_handle[a_off];
+	return m_handle[m_classes ? m_classes[a_off] : a_off];
 } ///< operator[]
 
 //------------------------------------------------------------------------------
-std::vector<Lettvin::Transition>&
+Lettvin::Transition*
 Lettvin::State::
 handle ()
 //------------------------------------------------------------------------------
@@ -112,7 +159,11 @@ Lettvin::Table::
 Table ()
 //------------------------------------------------------------------------------
 {
-	m_table.reserve (s_shape.prefill () * 256);
+	for (size_t byte=0; byte < m_classes.size (); ++byte)
+	{
+		m_classes[byte] = static_cast<uint8_t> (byte);
+	}
+	m_table.reserve (s_shape.prefill () * 256 * m_stride);
 	for (size_t i=0; i < s_shape.prefill (); ++i)
 	{
 		operator++ ();
@@ -121,12 +172,12 @@ Table ()
 } // ctor
 
 //------------------------------------------------------------------------------
-Lettvin::State&
+Lettvin::State
 Lettvin::Table::
-operator[] (uint8_t a_offset)
+operator[] (state_t a_offset)
 //------------------------------------------------------------------------------
 {
-	return m_table[a_offset & s_shape.mask ()];
+	return State (m_table.data () + a_offset * m_stride, m_classes.data ());
 } // operator[]
 
 //------------------------------------------------------------------------------
@@ -135,7 +186,7 @@ Lettvin::Table::
 operator++ ()
 //------------------------------------------------------------------------------
 {
-	m_table.resize (m_table.size () + 1);
+	m_table.resize (m_table.size () + m_stride);
 } // ++operator
 
 //------------------------------------------------------------------------------
@@ -144,7 +195,7 @@ Lettvin::Table::
 operator++ (int)
 //------------------------------------------------------------------------------
 {
-	m_table.resize (m_table.size () + 1);
+	m_table.resize (m_table.size () + m_stride);
 } // operator++
 
 //------------------------------------------------------------------------------
@@ -153,7 +204,7 @@ Lettvin::Table::
 size ()
 //------------------------------------------------------------------------------
 {
-	return m_table.size ();
+	return m_table.size () / m_stride;
 } // size
 
 //------------------------------------------------------------------------------
@@ -164,9 +215,9 @@ show_tables (ostream& a_os)
 {
 	size_t COLS{s_shape.nibbles () ? 4ULL : 16ULL};
 	size_t ROWS{s_shape.nibbles () ? 4ULL : 16ULL};
-	for (size_t state=0; state < m_table.size (); ++state)
+	for (state_t state=0; state < size (); ++state)
 	{
-		auto& plane{m_table[state]};
+		auto plane{operator[] (state)};
 		a_os << " # " << endl << " # ";
 		for (unsigned col=0; col < COLS; ++col)
 		{
@@ -251,18 +302,18 @@ insert (
 	{
 		debugf (1, "INSERT %2.2x and %2.2x on plane %x\n",
 				a_chars[0], a_chars[1], a_from);
-		Transition& transition{operator[] (a_from)[c0]};
-		auto to{transition.nxt ()};
+		auto to{operator[] (a_from)[c0].nxt ()};
 		a_next = a_from;
 		if (to) {
 			a_from = to;
 		}
 		else
 		{
+			// Growing the table moves planes: index again afterwards.
 			a_from = Table::size ();
 			operator++ ();
 		}
-		transition.nxt (a_from);
+		operator[] (a_next)[c0].nxt (a_from);
 		if (c0 != c1)
 		{
 			operator[] (a_next)[c1].nxt (a_from);
@@ -304,6 +355,24 @@ insert (string_view a_str, i24_t id, size_t setindex)
 		s_firsts += a_str[0];
 	}
 
+	// Over budget, dense planes give way to a double-array trie
+	// built from m_strings when sealed (see gg_bench sparse).
+	size_t dense{(size () + a_str.size ()) * m_stride * sizeof (Transition)};
+	if (!m_sparse && (s_shape.sparse () || dense > s_budget))
+	{
+		debugf (1, "SPARSE after %zu strings\n", m_strings.size ());
+		m_sparse = true;
+		Transitions planes (2 * s_shape.prefill () * m_stride);
+		m_table.swap (planes);
+	}
+	if (m_sparse)
+	{
+		m_longest = max (m_longest, a_str.size ());
+		m_strings.push_back (Inserted{string (a_str), s_caseless, i24_t (setindex)});
+		setitem.insert (id);
+		return setindex;
+	}
+
 	// Insert a_str into state transition tree
 	for (size_t I=a_str.size () - 1, i=0; i <= I; ++i)
 		//for (char u:str)
@@ -323,6 +392,9 @@ insert (string_view a_str, i24_t id, size_t setindex)
 		}
 	}
 
+	m_longest = max (m_longest, a_str.size ());
+	m_strings.push_back (Inserted{string (a_str), s_caseless, i24_t (setindex)});
+
 	debugf (1, "LINK %x %lx %x\n", next, last[0] & s_shape.mask (), id);
 	setitem.insert (id);
 
@@ -334,149 +406,1571 @@ insert (string_view a_str, i24_t id, size_t setindex)
 }
 
 //------------------------------------------------------------------------------
-// @brief dump tree to file
-//
-TODO(must output state size and table size)
-TODO(best practice read entire then swap if needed)
-TODO(output s_order.u64 to file to establish file order)
-void Lettvin::Table::dump (const char* a_filename, const char* a_title)
+/// @brief finish compilation once all strings are inserted
+///
+/// Byte planes are linked into an Aho-Corasick automaton,
+/// narrowed to one column per byte equivalence class,
+/// then equivalent states are merged.
+/// Nibble planes keep restarting at each anchor because a failure
+/// transition cannot be expressed between the two nibbles of a byte;
+/// they are only minimized.
+void
+Lettvin::Table::
+seal ()
+//------------------------------------------------------------------------------
+{
+	if (m_sealed) return;
+	m_sealed = true;
+	choose ();
+	if (m_sparse)
+	{
+		flatten ();
+		return;
+	}
+	if (!s_shape.nibbles ())
+	{
+		tails ();
+		link ();
+		compress ();
+	}
+	minimize ();
+	renumber ();
+	if (!s_shape.nibbles ())
+	{
+		tails (true);
+	}
+	flatten ();
+} // seal
+
+//------------------------------------------------------------------------------
+/// @brief the parts of seal which need only the inserted strings
+///
+/// Anchors, the engine, and the double-array trie are cheap to rebuild
+/// from m_strings, so load repeats this rather than storing them.
+void
+Lettvin::Table::
+choose ()
+//------------------------------------------------------------------------------
 {
-	int32_t fd = open (
-			a_filename,
-			O_RDWR|O_CREAT,
-			S_IRWXU|S_IRWXG|S_IRWXO);
-	if (fd > 0)
+	m_anchors.assign (s_firsts);
+	debugf (1, "ANCHORS %s\n", m_anchors.name ());
+	if (!m_sparse) anchor ();
+	engine ();
+	pairs ();
+	if (m_sparse && !m_bits && !m_manber)
 	{
-		debugf (1, "dump PASS: %s: %s\n", a_filename, a_title);
-		char   zero{0};
-		size_t endian{0x3736353433323130};
-		const char* cdcz{"\x04\x1a"};
-		size_t consumed{34+strlen (a_title)};
-		size_t needed{256-consumed};
+		for (auto& inserted:m_strings)
+		{
+			m_double.insert (inserted.m_str, inserted.m_caseless, inserted.m_set);
+		}
+		m_double.build ();
+		debugf (1, "DOUBLE %zu states %zu bytes\n",
+				m_double.states (), m_double.bytes ());
+	}
+} // choose
+
+//------------------------------------------------------------------------------
+/// @brief complete the trie into an Aho-Corasick DFA
+///
+/// Breadth-first, each state's failure is the longest proper suffix of
+/// its string which is also a prefix in the trie.
+/// A missing transition is replaced by the failure state's transition,
+/// which is already complete because failures are shallower.
+/// A present transition also emits the groups of the failure state's
+/// transition on the same byte (dictionary suffix outputs), merged into
+/// a new s_set entry when both are non-empty.
+/// nxt == 0 still means "back to root" so track may resume skipping.
+void
+Lettvin::Table::
+link ()
+//------------------------------------------------------------------------------
+{
+	size_t N{size ()};
+	vector<state_t> fail (N, 0);     ///< 0 means root
+	vector<bool>    seen (N, false);
+	map<pair<i24_t, i24_t>, i24_t> unions;
 
-		int N = int (strlen (a_title));
+	auto merge = [&] (i24_t a_own, i24_t a_suffix) -> i24_t
+	{
+		if (!a_suffix || a_own == a_suffix) return a_own;
+		if (!a_own) return a_suffix;
+		auto key{make_pair (a_own, a_suffix)};
+		auto found{unions.find (key)};
+		if (found != unions.end ()) return found->second;
+		set<int32_t> both{s_set[a_own]};
+		both.insert (s_set[a_suffix].begin (), s_set[a_suffix].end ());
+		i24_t index{static_cast<i24_t> (s_set.size ())};
+		s_set.emplace_back (both);
+		unions[key] = index;
+		return index;
+	};
 
-		assertf (8 != write (fd, "gg dump:", 8), 1, "dump 1 fail\n");
-		assertf (8 != write (fd, "endian: ", 8), 1, "dump 2 fail\n");
-		assertf (8 != write (fd, &endian   , 8), 1, "dump 3 fail\n");
-		assertf (8 != write (fd, " title: ", 8), 1, "dump 4 fail\n");
-		assertf (N != write (fd, a_title   , N), 1, "dump 5 fail\n");
-		assertf (2 != write (fd, cdcz      , 2), 1, "dump 6 fail\n");
-		for (size_t i=0; i<needed; ++i)
+	queue<state_t> bfs;
+	State root{operator[] (s_root)};
+	for (size_t c=0; c < 256; ++c)
+	{
+		auto q{root[c].nxt ()};
+		if (q && !seen[q])
 		{
-			assertf (1 != write (fd, &zero, 1), 1, "dump 7 fail\n");
+			seen[q] = true;
+			bfs.push (q);
 		}
-		
-		for (auto& state:m_table)
+	}
+	while (!bfs.empty ())
+	{
+		auto r{bfs.front ()};
+		bfs.pop ();
+		State here{operator[] (r)};
+		State back{operator[] (fail[r] ? fail[r] : s_root)};
+		for (size_t c=0; c < 256; ++c)
 		{
-			for (auto& atom: state.handle ())
+			Transition& to{here[c]};
+			Transition& by{back[c]};
+			auto q{to.nxt ()};
+			if (q)
+			{
+				to.grp (merge (to.grp (), by.grp ()));
+				if (!seen[q])
+				{
+					seen[q] = true;
+					fail[q] = by.nxt ();
+					bfs.push (q);
+				}
+			}
+			else
 			{
-				union { unsigned integral; uint8_t u08[4]; } datum{
-					.integral = atom.integral ()};
-				//write (fd, &datum.u08[s_order.u08.array[0]], 1);
-				//write (fd, &datum.u08[s_order.u08.array[1]], 1);
-				//write (fd, &datum.u08[s_order.u08.array[2]], 1);
-				//write (fd, &datum.u08[s_order.u08.array[3]], 1);
-				assertf (1 != write (fd, &datum.u08[0], 1), 1, "dump 8 fail\n");
-				assertf (1 != write (fd, &datum.u08[1], 1), 1, "dump 9 fail\n");
-				assertf (1 != write (fd, &datum.u08[2], 1), 1, "dump A fail\n");
-				assertf (1 != write (fd, &datum.u08[3], 1), 1, "dump B fail\n");
+				to.nxt (by.nxt ());
+				to.grp (by.grp ());
 			}
 		}
 	}
-	else
+	m_linked = true;
+	debugf (1, "LINKED %zu planes\n", N);
+} // link
+
+//------------------------------------------------------------------------------
+/// @brief find linear chains to leaves (before link)
+///
+/// A state whose trie path continues through single children to a leaf
+/// with no string ending on the way has a unique remaining literal.
+/// The head of each such chain (at least 4 bytes) gets a Tail so scan
+/// may compare the literal at once instead of one transition per byte.
+/// Caseless positions are the two cases of a letter leading to one child;
+/// chains mixing caseless and case-sensitive letters are not used.
+void
+Lettvin::Table::
+tails ()
+//------------------------------------------------------------------------------
+{
+	static const size_t shortest{4};
+	enum { CASELESS=1, SENSITIVE=2, BRANCHED=4 };
+	size_t N{size ()};
+	vector<state_t> child (N, 0), parent (N, 0);
+	vector<uint8_t> lower (N, 0), flags (N, 0);
+	vector<i24_t>   grp (N, 0);
+	vector<size_t>  length (N, 0);
+	vector<bool>    linear (N, false);
+	for (state_t state=s_root; state < N; ++state)
+	{
+		State plane{operator[] (state)};
+		uint8_t bytes[2]{0, 0};
+		size_t count{0};
+		for (size_t byte=0; byte < 256; ++byte)
+		{
+			auto& transition{plane[byte]};
+			state_t next{transition.nxt ()};
+			if (!next) continue;
+			parent[next] = state;
+			if (child[state] && child[state] != next) flags[state] |= BRANCHED;
+			child[state] = next;
+			grp[state] = transition.grp ();
+			if (count < 2) bytes[count] = static_cast<uint8_t> (byte);
+			++count;
+		}
+		bool alpha{!!isalpha (bytes[0])};
+		if (count == 1)
+		{
+			lower[state] = bytes[0];
+			if (alpha) flags[state] |= SENSITIVE;
+		}
+		else if (count == 2 && alpha && (bytes[0] ^ bytes[1]) == 0x20)
+		{
+			lower[state] = static_cast<uint8_t> (tolower (bytes[0]));
+			flags[state] |= CASELESS;
+		}
+		else if (count)
+		{
+			flags[state] |= BRANCHED;
+		}
+	}
+	// Children are always created after their parents.
+	for (size_t state=N; state-- > s_root + 1;)
+	{
+		state_t next{child[state]};
+		if (!next)
+		{
+			linear[state] = true;
+			continue;
+		}
+		if ((flags[state] & BRANCHED) || !linear[next]) continue;
+		if (grp[state] && child[next]) continue;
+		flags[state] |= flags[next] & (CASELESS | SENSITIVE);
+		if ((flags[state] & (CASELESS | SENSITIVE)) == (CASELESS | SENSITIVE))
+		{
+			continue;
+		}
+		length[state] = length[next] + 1;
+		linear[state] = true;
+	}
+
+	m_tail.assign (N, 0);
+	m_tails.clear ();
+	for (state_t state=s_root + 1; state < N; ++state)
 	{
-		debugf (1, "dump FAIL: %s: %s\n", a_filename, a_title);
+		if (!linear[state] || length[state] < shortest) continue;
+		if (parent[state] != s_root && linear[parent[state]]) continue;
+		Tail tail;
+		tail.m_caseless = flags[state] & CASELESS;
+		for (state_t at=state; child[at]; at=child[at])
+		{
+			tail.m_literal += static_cast<char> (lower[at]);
+		}
+		m_tails.emplace_back (tail);
+		m_tail[state] = m_tails.size ();
 	}
-	close (fd);
-}
+	debugf (1, "TAILS %zu\n", m_tails.size ());
+} // tails
 
 //------------------------------------------------------------------------------
-// @brief load tree from file
-void Lettvin::Table::load (const char* a_filename)
+/// @brief complete tails from the final table and flag their heads
+///
+/// After linking, a transition along a tail may also carry the groups of
+/// strings which are suffixes of it; such tails are dropped since
+/// comparing the literal would skip those groups.
+/// Transitions into a head are flagged so scan tests one bit per byte.
+void
+Lettvin::Table::
+tails (bool a_flag)
+//------------------------------------------------------------------------------
 {
-	int32_t fd = open (a_filename, O_RDONLY, 0);
-	if (fd >= 0)
+	for (state_t head=0; head < m_tail.size (); ++head)
 	{
+		if (!m_tail[head]) continue;
+		Tail& tail{m_tails[m_tail[head] - 1]};
+		state_t at{head};
+		size_t last{tail.m_literal.size () - 1};
+		for (size_t i=0; i <= last && m_tail[head]; ++i)
+		{
+			auto& transition{operator[] (at)[tail.m_literal[i]]};
+			if (i < last && transition.grp ()) m_tail[head] = 0;
+			tail.m_grp = transition.grp ();
+			tail.m_end = at = transition.nxt ();
+		}
+		if (!tail.m_end) m_tail[head] = 0;
 	}
-	close (fd);
-}
+	for (auto& transition:m_table)
+	{
+		state_t next{transition.nxt ()};
+		transition.tail (a_flag && next < m_tail.size () && m_tail[next]);
+	}
+	debugf (1, "TAILS %zu kept\n", size_t (count_if (
+					m_tail.begin (), m_tail.end (),
+					[] (uint32_t a_tail) { return a_tail != 0; })));
+} // tails
 
 //------------------------------------------------------------------------------
-/// @brief find and report found strings
+/// @brief anchor on the rarest byte of each string when cheaper
 ///
-/// when reject list is empty, terminate on completion of accept list
-/// when reject list is non-empty, terminate on first reject
+/// A string found at s contains its rarest byte at s+k, so a scan may
+/// jump to rare bytes and walk the FSM forward from each s = p-k.
+/// Expected work is compared using s_frequency: one walk per first
+/// letter found, versus one walk per offset k recorded for a rare byte.
+/// Rare anchoring is chosen only when it is at least twice as cheap.
 void
 Lettvin::Table::
-track (const void* a_pointer, size_t a_bytecount, const char* a_label)
+anchor ()
 //------------------------------------------------------------------------------
 {
-	//debugf (1, "SEARCH %s\n", a_label);
-	set<i24_t> accepted  {0};
-	set<i24_t> rejected  {};
-	string_view contents (static_cast<const char*> (a_pointer), a_bytecount);
-	size_t begin = contents.find_first_of (s_firsts);
-	bool done{false};
-	// outer loop (skip optimization)
-	while (begin != string_view::npos && !done)
+	auto cost = [] (uint8_t a_byte, bool a_caseless)
 	{
-		//debugf (1, "ANCHOR\n");
-		contents.remove_prefix (begin);
-		auto nxt{1}; // State
-		auto str{0}; // 
-		// inner loop (Finite State Machine optimization)
-		for (char c: contents)
+		uint8_t upper{static_cast<uint8_t> (toupper (a_byte))};
+		uint8_t lower{static_cast<uint8_t> (tolower (a_byte))};
+		if (!a_caseless || upper == lower) return double (s_frequency[a_byte]);
+		return double (s_frequency[upper]) + s_frequency[lower];
+	};
+
+	array<vector<uint32_t>, 256> back;
+	string rare;
+	for (auto& inserted:m_strings)
+	{
+		const string& str{inserted.m_str};
+		bool caseless{inserted.m_caseless};
+		if (str.empty ()) continue;
+		size_t k{0};
+		for (size_t i=1; i < str.size (); ++i)
 		{
-			//debugf (1, "OFFSET\n");
-			auto n00{c};
-			if (s_shape.nibbles ())
+			if (cost (str[i], caseless) < cost (str[k], caseless)) k = i;
+		}
+		uint8_t c{static_cast<uint8_t> (str[k])};
+		uint8_t cases[2]{c, c};
+		if (caseless)
+		{
+			cases[0] = static_cast<uint8_t> (toupper (c));
+			cases[1] = static_cast<uint8_t> (tolower (c));
+		}
+		for (auto byte:cases)
+		{
+			auto& offsets{back[byte]};
+			if (find (offsets.begin (), offsets.end (), k) == offsets.end ())
 			{
-				// Two-step for nibbles
-				n00 = (c>>4) & 0xf;
-				//debugf (1, "NIBBLE H %2.2x %2.2x\n", n00, nxt);
-				auto transition{operator[] (nxt)[n00]};
-				nxt = transition.nxt ();
-				n00 = c & 0xf;
-				//debugf (1, "NIBBLE L %2.2x %2.2x\n", n00, nxt);
-				if (!nxt) break;
+				offsets.push_back (k);
+				rare += static_cast<char> (byte);
 			}
-			else
+		}
+	}
+
+	double firsts{0}, rarely{0};
+	set<uint8_t> distinct (s_firsts.begin (), s_firsts.end ());
+	for (auto byte:distinct) firsts += s_frequency[byte];
+	size_t reach{0};
+	for (size_t byte=0; byte < 256; ++byte)
+	{
+		rarely += double (s_frequency[byte]) * back[byte].size ();
+		for (auto k:back[byte]) reach = max (reach, size_t (k));
+	}
+	m_rarely = !rare.empty () && 2 * rarely <= firsts;
+	debugf (1, "ANCHOR COST first %.0f rare %.0f: %s\n",
+			firsts, rarely, m_rarely ? "rare" : "first");
+	if (m_rarely)
+	{
+		m_rare.assign (rare);
+		m_back.swap (back);
+		m_reach = reach;
+	}
+} // anchor
+
+//------------------------------------------------------------------------------
+/// @brief skip to the first two bytes of strings, not the first
+///
+/// Nibble planes cost two dependent lookups per byte, so each false
+/// anchor is twice as dear as with byte planes.  When every string has
+/// two or more bytes, a double shufti on each byte and its successor
+/// rejects most false anchors 32 at a time before any plane is read
+/// (see gg_bench nibble; byte planes gain too).
+void
+Lettvin::Table::
+pairs ()
+//------------------------------------------------------------------------------
+{
+	m_pairs.clear ();
+	m_paired = false;
+	if (m_rarely || m_bits || m_manber) return;
+	for (auto& inserted:m_strings)
+	{
+		if (inserted.m_str.size () < 2) return;
+	}
+	for (auto& inserted:m_strings)
+	{
+		// Both cases of a caseless letter (insert ignores repeats).
+		auto cases = [&] (char a_c)
+		{
+			uint8_t c{static_cast<uint8_t> (a_c)};
+			if (!inserted.m_caseless) return array<uint8_t, 2>{c, c};
+			return array<uint8_t, 2>{
+				static_cast<uint8_t> (tolower (c)),
+				static_cast<uint8_t> (toupper (c))};
+		};
+		for (uint8_t first:cases (inserted.m_str[0]))
+		{
+			for (uint8_t second:cases (inserted.m_str[1]))
 			{
-				//debugf (1, "BYTE %c\n", c);
+				m_pairs.insert (first, second);
 			}
-			auto transition = operator[] (nxt)[n00];
-			nxt = transition.nxt ();
-			str = transition.grp ();
-			if (str) {
-				set<int32_t>& setitem{s_set[str]};
-				for (auto item:setitem)
+		}
+	}
+	m_pairs.prepare ();
+	m_paired = m_pairs.count () != 0;
+	debugf (1, "PAIRS %zu\n", m_pairs.count ());
+} // pairs
+
+//------------------------------------------------------------------------------
+/// @brief choose the Shift-And engine when all strings fit a word
+///
+/// Typical interactive queries total well under 128 bytes.
+/// Rare-byte anchoring is kept when chosen since it skips further.
+/// s_shift (--shift=N) caps the total; 0 always uses the planes.
+/// Large sets of strings of 4 or more bytes (--manber=N strings) use
+/// Wu-Manber block shifts instead, which skip further than either.
+void
+Lettvin::Table::
+engine ()
+//------------------------------------------------------------------------------
+{
+	size_t total{0}, shortest{~size_t (0)};
+	for (auto& inserted:m_strings)
+	{
+		total += inserted.m_str.size ();
+		shortest = min (shortest, inserted.m_str.size ());
+	}
+	m_bits = 0;
+	m_manber = s_manber && m_strings.size () >= s_manber && shortest >= 4;
+	if (m_manber)
+	{
+		for (auto& inserted:m_strings)
+		{
+			m_wumanber.insert (inserted.m_str, inserted.m_caseless, inserted.m_set);
+		}
+		m_wumanber.prepare ();
+		m_rarely = false;
+		debugf (1, "ENGINE wu-manber %zu strings of at least %zu bytes\n",
+				m_strings.size (), shortest);
+		return;
+	}
+	if (m_rarely || !total || total > min (s_shift, size_t (128))) return;
+	m_bits = total <= 64 ? 64 : 128;
+	for (auto& inserted:m_strings)
+	{
+		if (m_bits == 64)
+		{
+			m_shift64.insert (inserted.m_str, inserted.m_caseless, inserted.m_set);
+		}
+		else
+		{
+			m_shift128.insert (inserted.m_str, inserted.m_caseless, inserted.m_set);
+		}
+	}
+	debugf (1, "ENGINE shift-and %zu bits for %zu bytes\n", m_bits, total);
+} // engine
+
+//------------------------------------------------------------------------------
+/// @brief merge equivalent states (shared suffixes) into one plane
+///
+/// Moore partition refinement: states start in one block (plane 0 and
+/// the root are kept apart since the scan gives them meaning by number)
+/// and a block splits while its states differ in some column's grp or
+/// in the block of some column's nxt.  Variants share a grp set index,
+/// so their common suffix chains collapse into one chain of planes.
+/// Run after compress, a signature has m_stride columns rather than 256.
+/// Blocks are found by a hash of the signature; states with equal hashes
+/// are compared column by column, so no signature is ever stored.
+void
+Lettvin::Table::
+minimize ()
+//------------------------------------------------------------------------------
+{
+	static const state_t none{~state_t (0)};
+	size_t N{size ()};
+	vector<state_t> block (N, 2);
+	for (size_t state=0; state < m_tail.size (); ++state)
+	{
+		block[state] += m_tail[state];   ///< tail heads stay apart
+	}
+	block[0] = 0;
+	block[s_root] = 1;
+
+	auto hash = [&] (size_t a_state)
+	{
+		uint64_t value{block[a_state] * 0x100000001b3ULL};
+		const Transition* plane{&m_table[a_state * m_stride]};
+		for (size_t column=0; column < m_stride; ++column)
+		{
+			value = (value ^ uint64_t (plane[column].grp ())) * 0x100000001b3ULL;
+			value = (value ^ block[plane[column].nxt ()]) * 0x100000001b3ULL;
+		}
+		return value ^ (value >> 29);
+	};
+	auto same = [&] (size_t a_one, size_t a_two)
+	{
+		if (block[a_one] != block[a_two]) return false;
+		const Transition* one{&m_table[a_one * m_stride]};
+		const Transition* two{&m_table[a_two * m_stride]};
+		for (size_t column=0; column < m_stride; ++column)
+		{
+			if (one[column].grp () != two[column].grp () ||
+				block[one[column].nxt ()] != block[two[column].nxt ()])
+			{
+				return false;
+			}
+		}
+		return true;
+	};
+
+	size_t blocks{0};
+	for (;;)
+	{
+		unordered_map<uint64_t, state_t> heads;   ///< hash to first block
+		vector<state_t> first;                    ///< a member of each block
+		vector<state_t> chain;                    ///< next block, same hash
+		vector<state_t> refined (N);
+		heads.reserve (blocks ? blocks : N);
+		for (size_t state=0; state < N; ++state)
+		{
+			auto found{heads.emplace (hash (state), state_t (first.size ()))};
+			state_t at{found.first->second};
+			if (!found.second)
+			{
+				state_t last{at};
+				for (; at != none && !same (first[at], state); at=chain[at])
+				{
+					last = at;
+				}
+				if (at == none)
 				{
-					if (item < 0) return; ///< Immediate rejection
-					// If not immediate rejection, add to rejected list
-					auto& chose{(item>0)?accepted:rejected};
-					chose.insert (item);
-					bool full_accept{s_accept.size () == accepted.size ()};
-					// completion optimization
-					done = (s_noreject && full_accept);
-					if (done) break;
+					at = first.size ();
+					chain[last] = at;
 				}
 			}
-			if (done || !nxt) break;
+			if (at == first.size ())
+			{
+				first.push_back (state);
+				chain.push_back (none);
+			}
+			refined[state] = at;
 		}
-		contents.remove_prefix (1);
-		begin = contents.find_first_of (s_firsts);
+		block.swap (refined);
+		if (first.size () == blocks) break;
+		blocks = first.size ();
 	}
 
-	// Report files having all accepteds and no rejecteds.
-	if (!rejected.size () && accepted.size () == s_accept.size ())
+	// Number blocks by first member so plane 0 and the root keep theirs.
+	vector<state_t> number (blocks, 0);
+	vector<state_t> member;
+	vector<bool>    numbered (blocks, false);
+	for (size_t state=0; state < N; ++state)
 	{
-		auto report{fmt::format ("{}\n", a_label)};
-		// Using the unix write primitive guarantees atomicity
-		// This is needed to avoid thread contention
-		auto wrote = write (1, report.c_str (), report.size ());
-		// This next line should never be executed.
-		if (wrote == -1) printf ("%s\n", a_label);
+		if (!numbered[block[state]])
+		{
+			numbered[block[state]] = true;
+			number[block[state]] = member.size ();
+			member.push_back (state);
+		}
 	}
-} // track
+
+	Transitions merged (member.size () * m_stride);
+	for (size_t state=0; state < member.size (); ++state)
+	{
+		const Transition* plane{&m_table[member[state] * m_stride]};
+		for (size_t column=0; column < m_stride; ++column)
+		{
+			Transition& to{merged[state * m_stride + column]};
+			to.grp (plane[column].grp ());
+			to.nxt (number[block[plane[column].nxt ()]]);
+		}
+	}
+	debugf (1, "MINIMIZED %zu to %zu planes\n", N, member.size ());
+	m_table.swap (merged);
+	if (!m_tail.empty ())
+	{
+		vector<uint32_t> tail (member.size ());
+		for (size_t state=0; state < member.size (); ++state)
+		{
+			tail[state] = m_tail[member[state]];
+		}
+		m_tail.swap (tail);
+	}
+} // minimize
+
+//------------------------------------------------------------------------------
+/// @brief number planes breadth-first from the root
+///
+/// Insertion order scatters the shallow states a scan visits most among
+/// the deep ones of later strings.  Breadth-first, in column order, puts
+/// the root's neighbourhood in the first few pages of the table.
+/// Plane 0 and the root keep their numbers; unreachable planes go last.
+void
+Lettvin::Table::
+renumber ()
+//------------------------------------------------------------------------------
+{
+	size_t N{size ()};
+	vector<state_t> number (N, 0);
+	vector<state_t> member{0, s_root};
+	vector<bool>    numbered (N, false);
+	numbered[0] = numbered[s_root] = true;
+	number[s_root] = s_root;
+	for (size_t at=s_root; at < member.size (); ++at)
+	{
+		const Transition* plane{&m_table[member[at] * m_stride]};
+		for (size_t column=0; column < m_stride; ++column)
+		{
+			state_t next{plane[column].nxt ()};
+			if (numbered[next]) continue;
+			numbered[next] = true;
+			number[next] = member.size ();
+			member.push_back (next);
+		}
+	}
+	for (state_t state=0; state < N; ++state)
+	{
+		if (numbered[state]) continue;
+		number[state] = member.size ();
+		member.push_back (state);
+	}
+
+	Transitions ordered (N * m_stride);
+	for (size_t state=0; state < N; ++state)
+	{
+		const Transition* plane{&m_table[member[state] * m_stride]};
+		for (size_t column=0; column < m_stride; ++column)
+		{
+			Transition& to{ordered[state * m_stride + column]};
+			to.grp (plane[column].grp ());
+			to.nxt (number[plane[column].nxt ()]);
+		}
+	}
+	m_table.swap (ordered);
+	if (!m_tail.empty ())
+	{
+		vector<uint32_t> tail (N);
+		for (size_t state=0; state < N; ++state)
+		{
+			tail[state] = m_tail[member[state]];
+		}
+		m_tail.swap (tail);
+	}
+} // renumber
+
+//------------------------------------------------------------------------------
+/// @brief merge byte columns identical in every plane into classes
+///
+/// Two bytes which lead every state to the same Transition cannot be
+/// told apart by the automaton, so they share a column.
+/// Typically all bytes absent from the strings form one class
+/// and a plane shrinks from 256 Transitions to a few dozen.
+void
+Lettvin::Table::
+compress ()
+//------------------------------------------------------------------------------
+{
+	size_t N{size ()};
+	map<vector<integral_t>, uint8_t> columns;
+	vector<uint8_t> representative;
+	array<uint8_t, 256> classes;
+	for (size_t byte=0; byte < 256; ++byte)
+	{
+		vector<integral_t> column (N);
+		for (size_t state=0; state < N; ++state)
+		{
+			column[state] = m_table[state * m_stride + byte].integral ();
+		}
+		auto found{columns.find (column)};
+		if (found == columns.end ())
+		{
+			found = columns.emplace (
+					move (column), representative.size ()).first;
+			representative.push_back (static_cast<uint8_t> (byte));
+		}
+		classes[byte] = found->second;
+	}
+
+	size_t stride{representative.size ()};
+	Transitions packed (N * stride);
+	for (size_t state=0; state < N; ++state)
+	{
+		for (size_t column=0; column < stride; ++column)
+		{
+			packed[state * stride + column] =
+				m_table[state * m_stride + representative[column]];
+		}
+	}
+	debugf (1, "CLASSES %zu: %zu to %zu bytes\n", stride,
+			m_table.size () * sizeof (Transition),
+			packed.size () * sizeof (Transition));
+	m_table.swap (packed);
+	m_stride  = stride;
+	m_classes = classes;
+} // compress
+
+//------------------------------------------------------------------------------
+// Image (see gg_state.h) written by dump and mapped by load.
+namespace
+{
+	using namespace Lettvin;
+	using namespace Lettvin::Image;
+
+	//--------------------------------------------------------------------------
+	/// @brief pwrite all a_bytes at a_offset
+	bool
+	put (int a_fd, const void* a_data, size_t a_bytes, uint64_t a_offset)
+	//--------------------------------------------------------------------------
+	{
+		const char* at{static_cast<const char*> (a_data)};
+		while (a_bytes)
+		{
+			ssize_t wrote{pwrite (a_fd, at, a_bytes, off_t (a_offset))};
+			if (wrote <= 0) return false;
+			at += wrote;
+			a_offset += size_t (wrote);
+			a_bytes -= size_t (wrote);
+		}
+		return true;
+	} // put
+} // namespace
+
+//------------------------------------------------------------------------------
+/// @brief word-at-a-time multiplicative hash of a_bytes
+uint64_t
+Lettvin::Image::
+checksum (const void* a_data, size_t a_bytes, uint64_t a_hash)
+//------------------------------------------------------------------------------
+{
+	const uint8_t* at{static_cast<const uint8_t*> (a_data)};
+	for (; a_bytes >= 8; at += 8, a_bytes -= 8)
+	{
+		uint64_t word;
+		memcpy (&word, at, 8);
+		a_hash = (a_hash ^ word) * 0x100000001b3ULL;
+		a_hash ^= a_hash >> 29;
+	}
+	for (; a_bytes; ++at, --a_bytes)
+	{
+		a_hash = (a_hash ^ *at) * 0x100000001b3ULL;
+	}
+	return a_hash;
+} // checksum
+
+//------------------------------------------------------------------------------
+/// @brief write the sealed table as a mappable image (see load)
+///
+/// The image goes to a temporary file renamed over a_filename, so a
+/// concurrent load sees either the old image or the new one.
+/// mkstemp makes the temporary name unpredictable, never follows a
+/// planted link, and creates it 0600: images hold the query patterns.
+bool
+Lettvin::Table::
+dump (const char* a_filename, const char* a_title)
+//------------------------------------------------------------------------------
+{
+	if (!m_sealed) return false;
+	string temp{string (a_filename) + ".tmp.XXXXXX"};
+	int fd{mkstemp (&temp[0])};
+	bool written{fd >= 0 && dump (fd, a_title)};
+	written = fd >= 0 && !close (fd) && written;
+	written = written && !rename (temp.c_str (), a_filename);
+	if (!written) unlink (temp.c_str ());
+	debugf (1, "dump %s: %s: %s\n", written ? "PASS" : "FAIL",
+			a_filename, a_title);
+	return written;
+} // dump
+
+//------------------------------------------------------------------------------
+/// @brief write the sealed table's image at the start of a_fd
+///
+/// A loaded table writes the image it maps, unchanged.
+bool
+Lettvin::Table::
+dump (int a_fd, const char* a_title)
+//------------------------------------------------------------------------------
+{
+	if (!m_sealed) return false;
+	if (m_image.size ())
+	{
+		return put (a_fd, m_image.data (), m_image.size (), 0) &&
+			!ftruncate (a_fd, off_t (m_image.size ()));
+	}
+
+	string text;
+	auto record = [&] (string_view a_str, int32_t a_value,
+			uint32_t a_state=0, bool a_caseless=false)
+	{
+		Record entry{static_cast<uint32_t> (text.size ()),
+			static_cast<uint32_t> (a_str.size ()), a_value, a_state, a_caseless};
+		text += a_str;
+		return entry;
+	};
+	vector<Record> tails, strings, patterns;
+	for (auto& tail:m_tails)
+	{
+		tails.push_back (record (tail.m_literal, tail.m_grp,
+					tail.m_end, tail.m_caseless));
+	}
+	for (auto& inserted:m_strings)
+	{
+		strings.push_back (record (inserted.m_str, inserted.m_set,
+					0, inserted.m_caseless));
+	}
+	for (size_t id=1; id < s_accept.size (); ++id)
+	{
+		patterns.push_back (record (s_accept[id], int32_t (id)));
+	}
+	for (size_t id=1; id < s_reject.size (); ++id)
+	{
+		patterns.push_back (record (s_reject[id], -int32_t (id)));
+	}
+
+	Header header;
+	memset (&header, 0, sizeof (header));
+	memcpy (header.m_magic, s_magic, sizeof (s_magic));
+	header.m_layout  = s_layout;
+	header.m_page    = s_page;
+	header.m_order   = s_order;
+	header.m_stride  = m_stride;
+	header.m_longest = m_longest;
+	header.m_nibbles = s_shape.nibbles ();
+	header.m_linked  = m_linked;
+	header.m_sparse  = m_sparse;
+	copy (m_classes.begin (), m_classes.end (), header.m_classes);
+	strncpy (header.m_title, a_title, sizeof (header.m_title) - 1);
+
+	const void* data[PARTS]{
+		m_table.data (), m_offsets.data (), m_ids.data (), m_tail.data (),
+		tails.data (), strings.data (), patterns.data (),
+		s_firsts.data (), text.data ()};
+	size_t bytes[PARTS]{
+		m_table.size () * sizeof (Transition),
+		m_offsets.size () * sizeof (uint32_t),
+		m_ids.size () * sizeof (int32_t),
+		m_tail.size () * sizeof (uint32_t),
+		tails.size () * sizeof (Record),
+		strings.size () * sizeof (Record),
+		patterns.size () * sizeof (Record),
+		s_firsts.size (),
+		text.size ()};
+	uint64_t offset{s_page};
+	uint64_t hash{s_order};
+	for (size_t part=0; part < PARTS; ++part)
+	{
+		header.m_parts[part] = Section{offset, bytes[part]};
+		offset += (bytes[part] + s_page - 1) / s_page * s_page;
+		hash = checksum (data[part], bytes[part], hash);
+	}
+	header.m_bytes    = offset;
+	header.m_checksum = hash;
+
+	bool written{put (a_fd, &header, sizeof (header), 0)};
+	for (size_t part=0; part < PARTS && written; ++part)
+	{
+		written = put (a_fd, data[part], bytes[part], header.m_parts[part].m_offset);
+	}
+	return written && !ftruncate (a_fd, off_t (header.m_bytes));
+} // dump
+
+//------------------------------------------------------------------------------
+/// @brief map an image written by dump in place of compiling
+///
+/// The header, section bounds, and checksum are verified, and the
+/// image's patterns must be s_accept and s_reject since found reports
+/// their ids.  Every state, group, member and tail index is checked too.
+/// Planes, m_offsets and m_ids stay in the mapping; tails and strings
+/// are copied, and choose rebuilds anchors and engines from them.
+/// Only a fresh Table (nothing inserted) loads, and a refused image
+/// leaves the Table as it was.
+bool
+Lettvin::Table::
+load (const char* a_filename)
+//------------------------------------------------------------------------------
+{
+	int fd{open (a_filename, O_RDONLY)};
+	if (fd < 0) return false;
+	bool loaded{load (fd, a_filename)};
+	close (fd);
+	return loaded;
+} // load
+
+//------------------------------------------------------------------------------
+/// @brief map the image in a_fd (a file or shared memory) as load does
+bool
+Lettvin::Table::
+load (int a_fd, const char* a_filename)
+//------------------------------------------------------------------------------
+{
+	if (m_sealed || !m_strings.empty ()) return false;
+	struct stat st;
+	Region image;
+	if (fstat (a_fd, &st) || size_t (st.st_size) < s_page ||
+			!image.map (a_fd, size_t (st.st_size))) return false;
+	const char* base{image.data ()};
+	Header header;
+	memcpy (&header, base, sizeof (header));
+	if (memcmp (header.m_magic, s_magic, sizeof (s_magic)) ||
+			header.m_layout != s_layout ||
+			header.m_page != s_page ||
+			header.m_order != s_order ||
+			header.m_bytes != image.size () ||
+			bool (header.m_nibbles) != s_shape.nibbles () ||
+			!header.m_stride || header.m_stride > 256)
+	{
+		debugf (1, "load FAIL: %s: header\n", a_filename);
+		return false;
+	}
+	uint64_t hash{s_order};
+	for (auto& section:header.m_parts)
+	{
+		if (section.m_offset % s_page ||
+				section.m_offset > image.size () ||
+				section.m_bytes > image.size () - section.m_offset)
+		{
+			debugf (1, "load FAIL: %s: section\n", a_filename);
+			return false;
+		}
+		hash = checksum (base + section.m_offset, section.m_bytes, hash);
+	}
+	if (hash != header.m_checksum)
+	{
+		debugf (1, "load FAIL: %s: checksum\n", a_filename);
+		return false;
+	}
+
+	auto part = [&] (Part a_part) { return base + header.m_parts[a_part].m_offset; };
+	auto count = [&] (Part a_part, size_t a_size)
+	{
+		return size_t (header.m_parts[a_part].m_bytes / a_size);
+	};
+	const Record* records{reinterpret_cast<const Record*> (part (PATTERNS))};
+	const char*   text   {part (TEXT)};
+	size_t        length {header.m_parts[TEXT].m_bytes};
+	auto str = [&] (const Record& a_record)
+	{
+		if (a_record.m_offset > length ||
+				a_record.m_size > length - a_record.m_offset) return string_view ();
+		return string_view (text + a_record.m_offset, a_record.m_size);
+	};
+	size_t patterns{count (PATTERNS, sizeof (Record))};
+	bool same{patterns == s_accept.size () + s_reject.size () - 2};
+	for (size_t index=0; index < patterns && same; ++index)
+	{
+		int32_t id{records[index].m_value};
+		const vsv_t& list{id < 0 ? s_reject : s_accept};
+		size_t at{size_t (id < 0 ? -int64_t (id) : id)};
+		same = at && at < list.size () && list[at] == str (records[index]);
+	}
+	if (!same)
+	{
+		debugf (1, "load FAIL: %s: patterns differ\n", a_filename);
+		return false;
+	}
+
+	// Sections are decoded into locals: a refused image must leave this
+	// table untouched, since the caller then compiles into it instead.
+	size_t states{count (PLANES, sizeof (Transition)) / header.m_stride};
+	const uint32_t* tail{reinterpret_cast<const uint32_t*> (part (TAIL))};
+	vector<uint32_t> heads (tail, tail + count (TAIL, sizeof (uint32_t)));
+	vector<Tail> tails;
+	records = reinterpret_cast<const Record*> (part (TAILS));
+	for (size_t index=0; index < count (TAILS, sizeof (Record)); ++index)
+	{
+		Tail entry;
+		entry.m_literal  = string (str (records[index]));
+		entry.m_grp      = records[index].m_value;
+		entry.m_end      = records[index].m_state;
+		entry.m_caseless = records[index].m_caseless;
+		tails.emplace_back (entry);
+	}
+	vector<Inserted> strings;
+	records = reinterpret_cast<const Record*> (part (STRINGS));
+	for (size_t index=0; index < count (STRINGS, sizeof (Record)); ++index)
+	{
+		Inserted entry;
+		entry.m_str      = string (str (records[index]));
+		entry.m_set      = records[index].m_value;
+		entry.m_caseless = records[index].m_caseless;
+		strings.emplace_back (entry);
+	}
+
+	// The checksum catches damage, not forgery: anyone who can write the
+	// image can recompute it.  So every index a scan follows is checked
+	// against its section before the scans are let near it.
+	const Transition* planes {reinterpret_cast<const Transition*> (part (PLANES))};
+	const uint32_t*   groups {reinterpret_cast<const uint32_t*> (part (GROUPS))};
+	const int32_t*    members{reinterpret_cast<const int32_t*> (part (MEMBERS))};
+	size_t sets {count (GROUPS, sizeof (uint32_t))};
+	size_t items{count (MEMBERS, sizeof (int32_t))};
+	vector<bool> used (sets, false);    ///< groups this table can reach
+	auto group = [&] (int64_t a_grp)
+	{
+		if (!a_grp) return true;
+		if (a_grp < 0 || size_t (a_grp) + 1 >= sets) return false;
+		used[size_t (a_grp)] = true;
+		return true;
+	};
+	bool valid{states > s_root && sets && groups[sets - 1] <= items};
+	for (size_t byte=0; valid && byte < 256; ++byte)
+	{
+		valid = header.m_classes[byte] < header.m_stride;
+	}
+	for (size_t set=0; valid && set + 1 < sets; ++set)
+	{
+		valid = groups[set] <= groups[set + 1];
+	}
+	for (size_t at=0; valid && at < states * header.m_stride; ++at)
+	{
+		state_t next{planes[at].nxt ()};
+		valid = next < states && group (planes[at].grp ()) &&
+			(!planes[at].tail () || (next < heads.size () && heads[next]));
+	}
+	for (size_t head=0; valid && head < heads.size (); ++head)
+	{
+		valid = heads[head] <= tails.size ();
+	}
+	for (size_t index=0; valid && index < tails.size (); ++index)
+	{
+		valid = tails[index].m_end < states && group (tails[index].m_grp);
+	}
+	for (size_t index=0; valid && index < strings.size (); ++index)
+	{
+		valid = group (strings[index].m_set);
+	}
+	// s_set holds every group ever inserted; only reachable ones must
+	// name this query's patterns.
+	for (size_t set=0; valid && set + 1 < sets; ++set)
+	{
+		for (uint32_t item=groups[set]; valid && used[set] && item < groups[set + 1]; ++item)
+		{
+			int32_t id{members[item]};
+			size_t at{size_t (id < 0 ? -int64_t (id) : id)};
+			valid = at && at < (id < 0 ? s_reject : s_accept).size ();
+		}
+	}
+	if (!valid)
+	{
+		debugf (1, "load FAIL: %s: contents\n", a_filename);
+		return false;
+	}
+
+	m_tail.swap (heads);
+	m_tails.swap (tails);
+	m_strings.swap (strings);
+	s_firsts.assign (part (FIRSTS), header.m_parts[FIRSTS].m_bytes);
+	m_stride  = header.m_stride;
+	m_longest = header.m_longest;
+	m_linked  = header.m_linked;
+	m_sparse  = header.m_sparse;
+	copy (header.m_classes, header.m_classes + 256, m_classes.begin ());
+	Transitions ().swap (m_table);
+	m_offsets.clear ();
+	m_ids.clear ();
+	m_planes  = planes;
+	m_groups  = groups;
+	m_members = members;
+	m_image.swap (image);
+	m_sealed  = true;
+	choose ();
+	debugf (1, "load PASS: %s: %s %zu planes\n", a_filename, header.m_title, states);
+	return true;
+} // load
+
+//------------------------------------------------------------------------------
+/// @brief find and report found strings
+///
+/// when reject list is empty, terminate on completion of accept list
+/// when reject list is non-empty, terminate on first reject
+void
+Lettvin::Table::
+track (const void* a_pointer, size_t a_bytecount, const char* a_label)
+//------------------------------------------------------------------------------
+{
+	if (search (a_pointer, a_bytecount))
+	{
+		report (a_label);
+	}
+} // track
+
+//------------------------------------------------------------------------------
+/// @brief report a filename (atomic with respect to other threads)
+void
+Lettvin::Table::
+report (const char* a_label)
+//------------------------------------------------------------------------------
+{
+	auto report{fmt::format ("{}\n", a_label)};
+	// Using the unix write primitive guarantees atomicity
+	// This is needed to avoid thread contention
+	auto wrote = write (1, report.c_str (), report.size ());
+	// This next line should never be executed.
+	if (wrote == -1) printf ("%s\n", a_label);
+} // report
+
+//------------------------------------------------------------------------------
+/// @brief find strings
+///
+/// @returns true for contents having all accepteds and no rejecteds
+bool
+Lettvin::Table::
+search (const void* a_pointer, size_t a_bytecount, bool a_advise)
+//------------------------------------------------------------------------------
+{
+	thread_local Tally tally;
+	tally.reset ();
+	const char* begin{static_cast<const char*> (a_pointer)};
+	scan (begin, a_bytecount, a_bytecount, tally, nullptr, a_advise);
+	return verdict (tally);
+} // search
+
+//------------------------------------------------------------------------------
+/// @brief true for a tally having all accepteds and no rejecteds
+bool
+Lettvin::Table::
+verdict (const Tally& a_tally)
+//------------------------------------------------------------------------------
+{
+	return !a_tally.m_rejected && a_tally.accepts () == s_accept.size ();
+} // verdict
+
+//------------------------------------------------------------------------------
+/// @brief terminal group: accumulate accepts, stop on reject or completion
+///
+/// With reject strings only a reject ends the search early;
+/// without them only the full accept list does.
+/// Group a_str's ids are m_members[m_groups[a_str], m_groups[a_str + 1]).
+template<typename P>
+void
+Lettvin::Table::
+found (i24_t a_str, Tally& a_tally) const
+//------------------------------------------------------------------------------
+{
+	bool& done{a_tally.m_done};
+	for (uint32_t at=m_groups[a_str], end=m_groups[a_str + 1]; at < end; ++at)
+	{
+		int32_t item{m_members[at]};
+		if (P::rejects () && item < 0) ///< Immediate rejection
+		{
+			a_tally.m_rejected = done = true;
+			return;
+		}
+		a_tally.accept (item);
+		if (P::rejects ()) continue;
+		// completion optimization
+		done = s_accept.size () == a_tally.accepts ();
+		if (done) return;
+	}
+} // found
+
+//------------------------------------------------------------------------------
+/// @brief copy s_set into m_offsets and m_ids, point to m_table
+///
+/// s_set is a vector of std::set, convenient while inserting and linking
+/// but a tree walk per terminal while scanning.  Flat, a terminal reads
+/// one contiguous run of ids.  Sets are ascending, so rejects come first.
+/// Scans read through m_planes, m_groups and m_members, which load
+/// points into a mapped image instead.
+void
+Lettvin::Table::
+flatten ()
+//------------------------------------------------------------------------------
+{
+	m_offsets.assign (1, 0);
+	m_ids.clear ();
+	for (auto& items:s_set)
+	{
+		m_ids.insert (m_ids.end (), items.begin (), items.end ());
+		m_offsets.push_back (static_cast<uint32_t> (m_ids.size ()));
+	}
+	m_planes  = m_table.data ();
+	m_groups  = m_offsets.data ();
+	m_members = m_ids.data ();
+} // flatten
+
+//------------------------------------------------------------------------------
+/// @brief advance S disjoint streams of one buffer in lockstep
+///
+/// One stream is a single chain of dependent loads (state, then the
+/// next state's transition), so a core waits on cache latency.
+/// S independent chains interleave their loads and overlap that wait.
+/// Stream s starts at the root at the beginning of its segment of
+/// [0, a_anchors) and reads longest-1 bytes past its end, so every
+/// string starting in the segment completes within the stream.
+/// There is no skipping: every byte passes through the linked DFA.
+template<size_t S>
+void
+Lettvin::Table::
+interleave (
+		const char*         a_begin,
+		size_t              a_anchors,
+		size_t              a_count,
+		Tally&              a_tally,
+		const atomic<bool>* a_cancel)
+//------------------------------------------------------------------------------
+{
+	const Transition* planes {m_planes};
+	const size_t      stride {m_stride};
+	const uint8_t*    classes{m_classes.data ()};
+	const uint8_t*    text   {reinterpret_cast<const uint8_t*> (a_begin)};
+	const bool&       done   {a_tally.m_done};
+	size_t segment{(a_anchors + S - 1) / S};
+	size_t reach  {m_longest ? m_longest - 1 : 0};
+	size_t at[S], stop[S];
+	state_t nxt[S];
+	size_t common{a_count};
+	for (size_t s=0; s < S; ++s)
+	{
+		at[s]   = min (s * segment, a_anchors);
+		stop[s] = min (a_count, min ((s + 1) * segment, a_anchors) + reach);
+		nxt[s]  = s_root;
+		common  = min (common, stop[s] - at[s]);
+	}
+
+	// Lockstep while every stream has bytes; 0 means back to the root.
+	static const size_t block{1 << 16};
+	for (size_t step=0; step < common && !done;)
+	{
+		if (a_cancel && a_cancel->load (std::memory_order_relaxed)) return;
+		for (size_t until{min (common, step + block)}; step < until; ++step)
+		{
+			for (size_t s=0; s < S; ++s)
+			{
+				auto transition{planes[nxt[s] * stride +
+					classes[text[at[s] + step]]]};
+				state_t next{transition.nxt ()};
+				nxt[s] = next ? next : s_root;
+				if (auto str = transition.grp ()) found (str, a_tally);
+			}
+			if (done) return;
+		}
+	}
+	// Finish the longer streams one at a time.
+	for (size_t s=0; s < S && !done; ++s)
+	{
+		for (size_t offset=at[s] + common; offset < stop[s] && !done; ++offset)
+		{
+			auto transition{planes[nxt[s] * stride + classes[text[offset]]]};
+			state_t next{transition.nxt ()};
+			nxt[s] = next ? next : s_root;
+			if (auto str = transition.grp ()) found (str, a_tally);
+		}
+	}
+} // interleave
+
+//------------------------------------------------------------------------------
+/// @brief scan with the Shift-And engine instead of the planes
+///
+/// A zero state means no string is partly matched, like the root state:
+/// skip to the next first letter.  Otherwise step one byte at a time.
+template<typename W>
+void
+Lettvin::Table::
+shift (
+		const ShiftAnd<W>&  a_engine,
+		const char*         a_begin,
+		size_t              a_anchors,
+		size_t              a_count,
+		Tally&              a_tally,
+		const atomic<bool>* a_cancel)
+//------------------------------------------------------------------------------
+{
+	const uint8_t* text {reinterpret_cast<const uint8_t*> (a_begin)};
+	const bool&    done {a_tally.m_done};
+	size_t         limit{min (a_count, a_anchors + (m_longest ? m_longest - 1 : 0))};
+	auto report = [&] (i24_t a_grp) { if (!done) found (a_grp, a_tally); };
+	for (size_t at=m_anchors.find (a_begin, 0, a_anchors);
+			at != Anchors::npos && !done;
+			at=m_anchors.find (a_begin, at, a_anchors))
+	{
+		if (a_cancel && a_cancel->load (std::memory_order_relaxed)) return;
+		W state{0};
+		do
+		{
+			state = a_engine.step (state, text[at++]);
+			if (W hit = a_engine.final (state)) a_engine.each (hit, report);
+		}
+		while (state && at < limit && !done);
+	}
+} // shift
+
+//------------------------------------------------------------------------------
+/// @brief scan with the double-array trie instead of the planes
+///
+/// Like nibble planes, the trie has no failure links: walk from each
+/// anchor (first two letters) until no edge leads on.
+void
+Lettvin::Table::
+trie (
+		const char*         a_begin,
+		size_t              a_anchors,
+		size_t              a_count,
+		Tally&              a_tally,
+		const atomic<bool>* a_cancel)
+//------------------------------------------------------------------------------
+{
+	const uint8_t* text{reinterpret_cast<const uint8_t*> (a_begin)};
+	const bool&    done{a_tally.m_done};
+	auto anchor = [&] (size_t a_from)
+	{
+		return m_paired
+			? m_pairs.find (a_begin, a_from, min (a_count, a_anchors + 1))
+			: m_anchors.find (a_begin, a_from, a_anchors);
+	};
+	for (size_t begin=anchor (0);
+			begin != Anchors::npos && begin < a_anchors && !done;
+			begin=anchor (begin + 1))
+	{
+		if (a_cancel && a_cancel->load (std::memory_order_relaxed)) return;
+		uint32_t slot{DoubleArray::s_root};
+		for (size_t at=begin; at < a_count; ++at)
+		{
+			slot = m_double.next (slot, text[at]);
+			if (!slot) break;
+			if (i24_t grp = m_double.grp (slot))
+			{
+				found (grp, a_tally);
+				if (done) break;
+			}
+		}
+	}
+} // trie
+
+//------------------------------------------------------------------------------
+/// @brief find strings anchored in [0, a_anchors) of a_count bytes
+///
+/// Bytes beyond a_anchors are read only to complete candidates which
+/// begin before it; this lets adjacent chunks of a file overlap.
+void
+Lettvin::Table::
+scan (
+		const char*         a_begin,
+		size_t              a_anchors,
+		size_t              a_count,
+		Tally&              a_tally,
+		const atomic<bool>* a_cancel,
+		bool                a_advise)
+//------------------------------------------------------------------------------
+{
+	// Interleaved streams (--streams=N) replace skipping for large buffers.
+	if (m_linked && s_streams > 1 && a_anchors >= s_streams * 4096)
+	{
+		if      (s_streams >= 8) interleave<8> (a_begin, a_anchors, a_count, a_tally, a_cancel);
+		else if (s_streams >= 4) interleave<4> (a_begin, a_anchors, a_count, a_tally, a_cancel);
+		else                     interleave<2> (a_begin, a_anchors, a_count, a_tally, a_cancel);
+		return;
+	}
+
+	// Block-shift engine for large sets.
+	if (m_manber)
+	{
+		bool& done{a_tally.m_done};
+		m_wumanber.scan (a_begin, a_anchors, a_count,
+				[&] (i24_t a_grp) { found (a_grp, a_tally); return done; },
+				a_cancel);
+		return;
+	}
+
+	// Bit-parallel engine for small sets.
+	if (m_bits == 64)
+	{
+		shift (m_shift64, a_begin, a_anchors, a_count, a_tally, a_cancel);
+		return;
+	}
+	if (m_bits == 128)
+	{
+		shift (m_shift128, a_begin, a_anchors, a_count, a_tally, a_cancel);
+		return;
+	}
+
+	// Double-array trie for sets too large for planes.
+	if (m_sparse)
+	{
+		if (!m_sealed) seal ();
+		trie (a_begin, a_anchors, a_count, a_tally, a_cancel);
+		return;
+	}
+
+	// Fix the mode of the planes loop once, outside it.
+	bool tails{!m_tails.empty ()};
+	switch ((s_shape.nibbles () << 2) | (!s_noreject << 1) | tails)
+	{
+	case 0: sweep<Fixed<false, false, false>> (a_begin, a_anchors, a_count, a_tally, a_cancel, a_advise); break;
+	case 1: sweep<Fixed<false, false, true >> (a_begin, a_anchors, a_count, a_tally, a_cancel, a_advise); break;
+	case 2: sweep<Fixed<false, true , false>> (a_begin, a_anchors, a_count, a_tally, a_cancel, a_advise); break;
+	case 3: sweep<Fixed<false, true , true >> (a_begin, a_anchors, a_count, a_tally, a_cancel, a_advise); break;
+	case 4: sweep<Fixed<true , false, false>> (a_begin, a_anchors, a_count, a_tally, a_cancel, a_advise); break;
+	case 5: sweep<Fixed<true , false, true >> (a_begin, a_anchors, a_count, a_tally, a_cancel, a_advise); break;
+	case 6: sweep<Fixed<true , true , false>> (a_begin, a_anchors, a_count, a_tally, a_cancel, a_advise); break;
+	case 7: sweep<Fixed<true , true , true >> (a_begin, a_anchors, a_count, a_tally, a_cancel, a_advise); break;
+	}
+} // scan
+
+//------------------------------------------------------------------------------
+/// @brief the planes part of scan with its mode fixed by policy P
+///
+/// Nibble planes, reject strings, and literal tails are P's constants
+/// so the inner loops carry no mode tests (see gg_bench policy).
+template<typename P>
+void
+Lettvin::Table::
+sweep (
+		const char*         a_begin,
+		size_t              a_anchors,
+		size_t              a_count,
+		Tally&              a_tally,
+		const atomic<bool>* a_cancel,
+		bool                a_advise)
+//------------------------------------------------------------------------------
+{
+	// Unsealed tables (tests and debugging) may still be growing s_set.
+	if (!m_sealed) flatten ();
+
+	string_view contents (a_begin, a_count);
+	bool& done{a_tally.m_done};
+
+	// Next anchor at or after a_from: SIMD prefilter once sealed.
+	auto anchor = [&] (size_t a_from)
+	{
+		if (m_paired)
+		{
+			return m_pairs.find (a_begin, a_from, min (a_count, a_anchors + 1));
+		}
+		return m_sealed
+			? m_anchors.find (a_begin, a_from, a_anchors)
+			: contents.find_first_of (s_firsts, a_from);
+	};
+	size_t begin = anchor (0);
+
+	// Windowed read-ahead: keep one window ahead of the scan in flight.
+	// An early reject therefore never faults in the rest of a large file.
+	char* base{const_cast<char*> (a_begin)};
+	size_t window{s_window};
+	size_t advised{0};
+	auto advise = [&] (size_t a_offset)
+	{
+		while (a_advise && advised < a_count && advised <= a_offset + window)
+		{
+			size_t length{min (window, a_count - advised)};
+			madvise (base + advised, length, MADV_WILLNEED);
+			advised += length;
+		}
+	};
+	advise (0);
+
+	// Terminal group: accumulate accepts, stop on reject or completion.
+	auto terminal = [&] (i24_t a_str) { found<P> (a_str, a_tally); };
+
+	// One flat array: a transition is planes[state * stride + class].
+	// Before sealing, classes is the identity.
+	const Transition* planes {m_planes};
+	const size_t      stride {m_stride};
+	const uint8_t*    classes{m_classes.data ()};
+
+	// Literal tail: compare the rest of a linear chain all at once.
+	// On a mismatch the FSM continues one byte at a time.
+	auto leap = [&] (state_t& a_nxt, const char*& a_cursor, const char* a_stop)
+	{
+		const Tail& tail{m_tails[m_tail[a_nxt] - 1]};
+		size_t size{tail.m_literal.size ()};
+		if (a_cursor + size > a_stop) return;
+		if (!Anchors::equal (a_cursor, tail.m_literal.data (), size,
+					tail.m_caseless)) return;
+		a_cursor += size;
+		a_nxt = tail.m_end;
+		if (tail.m_grp) terminal (tail.m_grp);
+	};
+
+	if (m_rarely)
+	{
+		// Jump to rare bytes; walk forward from each string start they imply.
+		// Only starts in [0, a_anchors) belong to this call.
+		auto walk = [&] (size_t a_start)
+		{
+			state_t nxt{s_root};
+			const char* stop{a_begin + min (a_count, a_start + m_longest)};
+			for (const char* at=a_begin + a_start; at < stop;)
+			{
+				uint8_t c{static_cast<uint8_t> (*at++)};
+				if (P::nibbles ())
+				{
+					nxt = planes[nxt * stride + (c >> 4)].nxt ();
+					if (!nxt) break;
+					c &= 0xf;
+				}
+				auto transition{planes[nxt * stride + classes[c]]};
+				nxt = transition.nxt ();
+				if (auto str = transition.grp ()) terminal (str);
+				if (done || !nxt) break;
+				if (P::tails () && transition.tail ()) leap (nxt, at, stop);
+				if (done) break;
+			}
+		};
+		size_t limit{min (a_count, a_anchors + m_reach)};
+		for (size_t at=m_rare.find (a_begin, 0, limit);
+				at != Anchors::npos && !done;
+				at=m_rare.find (a_begin, at + 1, limit))
+		{
+			if (a_cancel && a_cancel->load (std::memory_order_relaxed)) break;
+			advise (at);
+			for (auto k:m_back[static_cast<uint8_t> (a_begin[at])])
+			{
+				if (k > at || at - k >= a_anchors) continue;
+				walk (at - k);
+				if (done) break;
+			}
+		}
+		return;
+	}
+
+	if (m_linked)
+	{
+		// Aho-Corasick: each byte is consumed exactly once.
+		// Skip with find_first_of only while in the root state (nxt == 0).
+		const char* cursor{a_begin};
+		const char* end   {a_begin + a_count};
+		state_t     nxt   {0};
+		while (!done)
+		{
+			if (!nxt)
+			{
+				size_t offset{size_t (cursor - a_begin)};
+				if (offset >= a_anchors) break;
+				begin = anchor (offset);
+				if (begin == string_view::npos || begin >= a_anchors) break;
+				if (a_cancel && a_cancel->load (std::memory_order_relaxed)) break;
+				advise (begin);
+				cursor = a_begin + begin;
+				nxt = s_root;
+			}
+			// inner loop (Finite State Machine optimization)
+			while (cursor < end)
+			{
+				uint8_t column{classes[uint8_t (*cursor++)]};
+				auto transition{planes[nxt * stride + column]};
+				nxt = transition.nxt ();
+				auto str = transition.grp ();
+				if (str) terminal (str);
+				if (done || !nxt) break;
+				if (P::tails () && transition.tail ()) leap (nxt, cursor, end);
+				if (done) break;
+			}
+			if (cursor >= end) break;
+		}
+		return;
+	}
+
+	// outer loop (skip optimization)
+	while (begin != string_view::npos && !done)
+	{
+		//debugf (1, "ANCHOR\n");
+		if (begin >= a_anchors) break;
+		if (a_cancel && a_cancel->load (std::memory_order_relaxed)) break;
+		advise (begin);
+		state_t nxt{s_root}; // State
+		i24_t   str{0};      // 
+		// inner loop (Finite State Machine optimization)
+		for (char c: contents.substr (begin))
+		{
+			//debugf (1, "OFFSET\n");
+			auto n00{c};
+			if (P::nibbles ())
+			{
+				// Two-step for nibbles
+				n00 = (c>>4) & 0xf;
+				//debugf (1, "NIBBLE H %2.2x %2.2x\n", n00, nxt);
+				auto transition{planes[nxt * stride + uint8_t (n00)]};
+				nxt = transition.nxt ();
+				n00 = c & 0xf;
+				//debugf (1, "NIBBLE L %2.2x %2.2x\n", n00, nxt);
+				if (!nxt) break;
+			}
+			else
+			{
+				//debugf (1, "BYTE %c\n", c);
+			}
+			auto transition{planes[nxt * stride + uint8_t (n00)]};
+			nxt = transition.nxt ();
+			str = transition.grp ();
+			if (str) terminal (str);
+			if (done || !nxt) break;
+		}
+		begin = anchor (begin + 1);
+	}
+} // sweep
+
+template void Lettvin::Table::sweep<Lettvin::Table::Dynamic> (
+		const char*, size_t, size_t, Tally&, const atomic<bool>*, bool);
 
@@ -24,11 +24,18 @@ _____________________________________________________________________________*/
 
 #pragma once
 
+#include <array>
 #include <vector>
+#include <set>
+#include <atomic>
 #include <string_view>
 
 #include "gg_globals.h"
 #include "gg_utility.h"
+#include "gg_anchor.h"
+#include "gg_shift.h"
+#include "gg_wumanber.h"
+#include "gg_darray.h"
 
 namespace Lettvin
 {
@@ -115,10 +122,12 @@ namespace Lettvin
 	//------
 		Transition ();
 		integral_t  integral () const;
-		uint8_t          nxt () const;
+		state_t          nxt () const;
 		i24_t            grp () const;
-		void             nxt (uint8_t a_nxt);
+		bool            tail () const;
+		void             nxt (state_t a_nxt);
 		void             grp (i24_t a_grp);
+		void            tail (bool a_tail);
 	//------
 	private:
 	//------
@@ -126,7 +135,8 @@ namespace Lettvin
 			integral_t integral;                         ///< all bit fields
 			struct {
 				i24_t   grp:24;  ///< group id for found sequences
-				uint8_t nxt;     ///< next state plane for continued search
+				uint32_t tail:1; ///< nxt begins a literal tail (Table::Tail)
+				state_t nxt;     ///< next state plane for continued search
 			} state;
 		}
 		m_the
@@ -135,10 +145,16 @@ namespace Lettvin
 		};
 	}; // class Transition
 
+	static_assert (sizeof (Transition) == sizeof (integral_t));
+
+	typedef vector<Transition, Aligned<Transition>> Transitions;
+
 	//CCCCCCCCCCCCCCCCCCCCCCCCCCCCCCCCCCCCCCCCCCCCCCCCCCCCCCCCCCCCCCCCCCCCCCCCCC
-	/// @brief Single state-transition plane of 256 Transition
+	/// @brief Single state-transition plane of 256 (or 16) Transition
 	///
-	/// constructor/indexer
+	/// A default-constructed State owns its plane.
+	/// A State returned by Table::operator[] views a plane of the Table
+	/// and is valid until the Table grows.
 	//__________________________________________________________________________
 	class
 	State
@@ -147,18 +163,104 @@ namespace Lettvin
 	public:
 	//------
 		State ();
+		State (Transition* a_plane, const uint8_t* a_classes);
+		State (const State& a_other);
 		Transition& operator[] (uint8_t a_off);
-		vector<Transition>& handle ();
+		Transition* handle ();
 	//------
 	private:
 	//------
-		vector<Transition> m_handle;
+		Transitions    m_owned;
+		Transition*    m_handle;
+		const uint8_t* m_classes{nullptr};   ///< byte to column (or identity)
 	}; // class State
 
+	//__________________________________________________________________________
+	/// @brief accept/reject progress of a search over all or part of a file
+	///
+	/// Tallies of chunks of one file merge into the tally of the file.
+	/// Accept ids are bits (id 0 always set, as s_accept[0] is empty)
+	/// so completion compares their count with s_accept.size ().
+	/// accept counts new bits as it sets them; merge recounts by popcount.
+	/// reset () reuses the words: a per-thread Tally allocates once.
+	struct Tally
+	{
+		vector<uint64_t> m_accepted;           ///< bit per accept id
+		size_t           m_count   {1};        ///< bits set in m_accepted
+		bool             m_rejected{false};    ///< a reject id was found
+		bool             m_done    {false};    ///< verdict cannot change
+
+		Tally () { reset (); }
+
+		//----------------------------------------------------------------------
+		/// @brief forget all ids, sized for s_accept (no reallocation)
+		void reset ()
+		{
+			m_accepted.assign ((s_accept.size () >> 6) + 1, 0);
+			m_accepted[0] = 1;
+			m_count = 1;
+			m_rejected = m_done = false;
+		}
+
+		//----------------------------------------------------------------------
+		void accept (int32_t a_id)
+		{
+			size_t word{size_t (a_id) >> 6};
+			if (word >= m_accepted.size ()) m_accepted.resize (word + 1, 0);
+			uint64_t bit{uint64_t (1) << (a_id & 63)};
+			m_count += !(m_accepted[word] & bit);
+			m_accepted[word] |= bit;
+		}
+
+		//----------------------------------------------------------------------
+		bool accepted (int32_t a_id) const
+		{
+			size_t word{size_t (a_id) >> 6};
+			return word < m_accepted.size () &&
+				(m_accepted[word] >> (a_id & 63)) & 1;
+		}
+
+		//----------------------------------------------------------------------
+		/// @brief count of accept ids found (including 0)
+		size_t accepts () const { return m_count; }
+
+		//----------------------------------------------------------------------
+		/// @brief accept ids found, ascending (for tests and debugging)
+		vector<i24_t> ids () const
+		{
+			vector<i24_t> found;
+			for (size_t word=0; word < m_accepted.size (); ++word)
+			{
+				for (uint64_t bits=m_accepted[word]; bits; bits &= bits - 1)
+				{
+					found.push_back (i24_t (word * 64 + __builtin_ctzll (bits)));
+				}
+			}
+			return found;
+		}
+
+		//----------------------------------------------------------------------
+		void merge (const Tally& a_other)
+		{
+			if (a_other.m_accepted.size () > m_accepted.size ())
+			{
+				m_accepted.resize (a_other.m_accepted.size (), 0);
+			}
+			for (size_t word=0; word < a_other.m_accepted.size (); ++word)
+			{
+				m_accepted[word] |= a_other.m_accepted[word];
+			}
+			m_count = 0;
+			for (auto word:m_accepted) m_count += __builtin_popcountll (word);
+			m_rejected |= a_other.m_rejected;
+		}
+	}; // struct Tally
+
 	//CCCCCCCCCCCCCCCCCCCCCCCCCCCCCCCCCCCCCCCCCCCCCCCCCCCCCCCCCCCCCCCCCCCCCCCCCC
 	/// @brief vector of state-transition planes sufficient to enable search
 	///
-	/// constructor/indexer
+	/// All planes share one cache-line aligned array indexed
+	/// state*stride+byte so a transition costs a single dependent load.
 	//__________________________________________________________________________
 	class
 	Table
@@ -167,14 +269,36 @@ namespace Lettvin
 	public:
 	//------
 
+		//----------------------------------------------------------------------
+		/// @brief scan loop mode read from the globals at every use
+		struct Dynamic
+		{
+			static bool nibbles () { return s_shape.nibbles (); }
+			static bool rejects () { return !s_noreject; }
+			static bool tails   () { return true; }
+		};
+
+		//----------------------------------------------------------------------
+		/// @brief scan loop mode fixed at compile time
+		///
+		/// N: nibble planes, R: reject strings exist, T: literal tails exist.
+		/// Every combination is instantiated; scan picks one before looping.
+		template<bool N, bool R, bool T>
+		struct Fixed
+		{
+			static constexpr bool nibbles () { return N; }
+			static constexpr bool rejects () { return R; }
+			static constexpr bool tails   () { return T; }
+		};
+
 		//----------------------------------------------------------------------
 		/// @brief Table ctor (reserve many, instance 2)
 		Table ();
 
 		//----------------------------------------------------------------------
 		/// @brief indexer
-		State&
-		operator[] (uint8_t a_offset);
+		State
+		operator[] (state_t a_offset);
 
 		//----------------------------------------------------------------------
 		/// @brief add State planes to vector
@@ -190,6 +314,10 @@ namespace Lettvin
 		/// @brief return current size of vector
 		size_t size ();
 
+		//----------------------------------------------------------------------
+		/// @brief Transitions per plane (byte class count once sealed)
+		size_t stride () const { return m_stride; }
+
 		//----------------------------------------------------------------------
 		/// @brief debug utility for displaying the entire table
 		ostream&
@@ -201,14 +329,35 @@ namespace Lettvin
 		insert (string_view a_str, i24_t id, size_t seti=0);
 
 		//----------------------------------------------------------------------
-		/// @brief dump tree to file
+		/// @brief finish compilation once all strings are inserted
 		void
-		dump (const char* filename, const char* a_title="");
+		seal ();
 
 		//----------------------------------------------------------------------
-		/// @brief load tree from file
-		void
-		load (const char* filename);
+		/// @brief write the sealed table as a mappable image (see load)
+		///
+		/// @returns false when the file cannot be written
+		bool
+		dump (const char* a_filename, const char* a_title="");
+
+		//----------------------------------------------------------------------
+		/// @brief write the image to a_fd (a file or shared memory)
+		bool
+		dump (int a_fd, const char* a_title="");
+
+		//----------------------------------------------------------------------
+		/// @brief map an image written by dump in place of compiling
+		///
+		/// Planes and terminal groups are used in place, read-only.
+		/// The image must match s_accept, s_reject and the shape.
+		/// @returns false (leaving the table unchanged) otherwise
+		bool
+		load (const char* a_filename);
+
+		//----------------------------------------------------------------------
+		/// @brief map the image in a_fd; a_fd may be closed afterwards
+		bool
+		load (int a_fd, const char* a_filename="");
 
 		//----------------------------------------------------------------------
 		/// @brief find and report found strings
@@ -218,15 +367,127 @@ namespace Lettvin
 		void
 		track (const void* a_ptr, size_t a_count, const char* a_label="");
 
-		//void
-		//track_and_report (void* a_ptr, size_t a_count, const char* a_label="");
+		//----------------------------------------------------------------------
+		/// @brief find strings without reporting
+		///
+		/// a_advise is for memory-mapped contents: windows of s_window
+		/// bytes are advised MADV_WILLNEED just ahead of the scan.
+		///
+		/// @returns true for all accept strings found and no reject strings
+		bool
+		search (const void* a_ptr, size_t a_count, bool a_advise=false);
+
+		//----------------------------------------------------------------------
+		/// @brief find strings anchored in [0, a_anchors) of a_count bytes
+		///
+		/// Candidates anchored before a_anchors may read up to a_count.
+		/// a_cancel (when set by another thread) stops the scan early.
+		void
+		scan (
+				const char*         a_begin,
+				size_t              a_anchors,
+				size_t              a_count,
+				Tally&              a_tally,
+				const atomic<bool>* a_cancel=nullptr,
+				bool                a_advise=false);
+
+		//----------------------------------------------------------------------
+		/// @brief the planes part of scan with its mode fixed by policy P
+		///
+		/// scan calls this with a Fixed policy after choosing no other
+		/// engine; gg_bench policy compares it with Dynamic.
+		template<typename P>
+		void
+		sweep (
+				const char*         a_begin,
+				size_t              a_anchors,
+				size_t              a_count,
+				Tally&              a_tally,
+				const atomic<bool>* a_cancel=nullptr,
+				bool                a_advise=false);
+
+		//----------------------------------------------------------------------
+		/// @brief true for a tally with all accept and no reject strings
+		static bool
+		verdict (const Tally& a_tally);
+
+		//----------------------------------------------------------------------
+		/// @brief bits of the Shift-And engine in use (0 for the planes)
+		size_t bits () const { return m_bits; }
+
+		//----------------------------------------------------------------------
+		/// @brief true when the Wu-Manber engine is in use
+		bool manber () const { return m_manber; }
+
+		//----------------------------------------------------------------------
+		/// @brief true when a double-array trie replaces the planes
+		bool sparse () const { return m_sparse; }
+
+		//----------------------------------------------------------------------
+		/// @brief bytes of the double-array trie (0 unless sparse)
+		size_t bytes () const { return m_double.bytes (); }
+
+		//----------------------------------------------------------------------
+		/// @brief length of the longest inserted string
+		size_t longest () const { return m_longest; }
+
+		//----------------------------------------------------------------------
+		/// @brief write a_label and newline to stdout in one write
+		static void
+		report (const char* a_label);
 
 	//--------
 	protected:
 	//--------
 
 		//dddddddddddddddddddddddddddddddddddddddddddddddddddddddddddddddddddddd
-		vector<State> m_table;                       ///< State tables
+		Transitions   m_table;                       ///< planes, contiguous
+		size_t        m_stride{s_shape.size ()};     ///< Transitions per plane
+		array<uint8_t, 256> m_classes;               ///< byte to column
+		size_t        m_longest{0};                  ///< longest string
+		bool          m_linked{false};               ///< Aho-Corasick DFA
+		bool          m_sealed{false};               ///< seal has run
+		Anchors       m_anchors;                     ///< first letters
+		vector<uint32_t> m_offsets;                  ///< group to m_ids start
+		vector<int32_t>  m_ids;                      ///< s_set ids, flat
+		Pairs         m_pairs;                       ///< first two letters
+		bool          m_paired{false};               ///< m_pairs replaces
+		const Transition* m_planes {nullptr};        ///< m_table or m_image
+		const uint32_t*   m_groups {nullptr};        ///< m_offsets or m_image
+		const int32_t*    m_members{nullptr};        ///< m_ids or m_image
+		Region        m_image;                       ///< loaded by load
+
+		//----------------------------------------------------------------------
+		/// @brief literal remainder of a linear chain of states to a leaf
+		struct Tail
+		{
+			string  m_literal;         ///< remaining bytes (lower if caseless)
+			bool    m_caseless{false}; ///< compare letters caselessly
+			i24_t   m_grp     {0};     ///< group of the final transition
+			state_t m_end     {0};     ///< state after the final transition
+		};
+		vector<Tail>     m_tails;                    ///< literal tails
+		vector<uint32_t> m_tail;                     ///< state to tail + 1
+		//----------------------------------------------------------------------
+		/// @brief a string as inserted
+		struct Inserted
+		{
+			string m_str;                  ///< bytes
+			bool   m_caseless{false};      ///< s_caseless when inserted
+			i24_t  m_set     {0};          ///< s_set index of its terminal
+		};
+		vector<Inserted> m_strings;                  ///< all inserted
+		bool          m_rarely{false};               ///< anchor on rare bytes
+		Anchors       m_rare;                        ///< rarest byte of each
+		array<vector<uint32_t>, 256> m_back;         ///< rare byte offsets
+		size_t        m_reach{0};                    ///< largest rare offset
+		size_t        m_bits{0};                     ///< Shift-And width
+		ShiftAnd<uint64_t>          m_shift64;       ///< m_bits == 64
+		ShiftAnd<unsigned __int128> m_shift128;      ///< m_bits == 128
+		bool          m_manber{false};               ///< Wu-Manber in use
+		bool          m_sparse{false};               ///< double array in use
+		DoubleArray   m_double;                      ///< m_sparse trie
+		WuManber      m_wumanber;                    ///< large sets
 
 	//------
 	private:
@@ -244,6 +505,158 @@ namespace Lettvin
 				bool  a_stop=false,
 				bool  a_nibbles=false);
 
+		//----------------------------------------------------------------------
+		/// @brief add failure transitions to make a single-pass DFA
+		void
+		link ();
+
+		//----------------------------------------------------------------------
+		/// @brief terminal group: accumulate accepts, stop on reject
+		template<typename P=Dynamic>
+		void
+		found (i24_t a_str, Tally& a_tally) const;
+
+		//----------------------------------------------------------------------
+		/// @brief copy s_set into m_offsets and m_ids, point to m_table
+		void
+		flatten ();
+
+		//----------------------------------------------------------------------
+		/// @brief advance S disjoint streams of one buffer in lockstep
+		template<size_t S>
+		void
+		interleave (
+				const char*         a_begin,
+				size_t              a_anchors,
+				size_t              a_count,
+				Tally&              a_tally,
+				const atomic<bool>* a_cancel);
+
+		//----------------------------------------------------------------------
+		/// @brief scan with the Shift-And engine instead of the planes
+		template<typename W>
+		void
+		shift (
+				const ShiftAnd<W>&  a_engine,
+				const char*         a_begin,
+				size_t              a_anchors,
+				size_t              a_count,
+				Tally&              a_tally,
+				const atomic<bool>* a_cancel);
+
+		//----------------------------------------------------------------------
+		/// @brief scan with the double-array trie instead of the planes
+		void
+		trie (
+				const char*         a_begin,
+				size_t              a_anchors,
+				size_t              a_count,
+				Tally&              a_tally,
+				const atomic<bool>* a_cancel);
+
+		//----------------------------------------------------------------------
+		/// @brief the parts of seal which need only the inserted strings
+		void
+		choose ();
+
+		//----------------------------------------------------------------------
+		/// @brief choose the Shift-And or Wu-Manber engine by set size
+		void
+		engine ();
+
+		//----------------------------------------------------------------------
+		/// @brief find linear chains to leaves (before link)
+		void
+		tails ();
+
+		//----------------------------------------------------------------------
+		/// @brief complete tails from the final table and flag their heads
+		void
+		tails (bool a_flag);
+
+		//----------------------------------------------------------------------
+		/// @brief anchor on the rarest byte of each string when cheaper
+		void
+		anchor ();
+
+		//----------------------------------------------------------------------
+		/// @brief skip to the first two bytes of strings, not the first
+		void
+		pairs ();
+
+		//----------------------------------------------------------------------
+		/// @brief merge equivalent states (shared suffixes) into one plane
+		void
+		minimize ();
+
+		//----------------------------------------------------------------------
+		/// @brief number planes breadth-first from the root for locality
+		void
+		renumber ();
+
+		//----------------------------------------------------------------------
+		/// @brief merge byte columns identical in every plane into classes
+		void
+		compress ();
+
 	}; // class Table
 
+	//__________________________________________________________________________
+	/// @brief image written by Table::dump and mapped by Table::load
+	///
+	/// A header page is followed by page-aligned sections, each a plain array
+	/// in host byte order, so load points into the mapping with no parsing.
+	/// The checksum runs over the sections in Part order from s_order.
+	namespace Image
+	{
+		static constexpr char     s_magic[8]{'g', 'g', ' ', 't', 'a', 'b', 'l', 'e'};
+		static constexpr uint32_t s_layout{1};                   ///< image version
+		static constexpr uint64_t s_order {0x0706050403020100};  ///< host byte order
+		static constexpr size_t   s_page  {4096};                ///< section alignment
+
+		enum Part { PLANES, GROUPS, MEMBERS, TAIL, TAILS, STRINGS, PATTERNS,
+			FIRSTS, TEXT, PARTS };
+
+		struct Section
+		{
+			uint64_t m_offset;         ///< from the start of the file
+			uint64_t m_bytes;          ///< unpadded
+		};
+
+		struct Header
+		{
+			char     m_magic[8];       ///< s_magic
+			uint32_t m_layout;         ///< s_layout
+			uint32_t m_page;           ///< s_page
+			uint64_t m_order;          ///< s_order as written
+			uint64_t m_checksum;       ///< of the sections in Part order
+			uint64_t m_bytes;          ///< file size
+			uint64_t m_stride;         ///< Transitions per plane
+			uint64_t m_longest;        ///< longest string
+			uint8_t  m_nibbles;        ///< s_shape.nibbles ()
+			uint8_t  m_linked;         ///< Aho-Corasick DFA
+			uint8_t  m_sparse;         ///< double-array trie (planes unused)
+			uint8_t  m_reserved[5];
+			uint8_t  m_classes[256];   ///< byte to column
+			Section  m_parts[PARTS];
+			char     m_title[64];      ///< dump a_title, truncated
+		};
+		static_assert (sizeof (Header) <= s_page, "header exceeds a page");
+
+		/// One string in TEXT: a tail, an inserted string, or a pattern.
+		struct Record
+		{
+			uint32_t m_offset;         ///< in TEXT
+			uint32_t m_size;
+			int32_t  m_value;          ///< tail grp, string set, or pattern id
+			uint32_t m_state;          ///< tail end
+			uint32_t m_caseless;
+		};
+
+		//----------------------------------------------------------------------
+		/// @brief word-at-a-time multiplicative hash of a_bytes
+		uint64_t
+		checksum (const void* a_data, size_t a_bytes, uint64_t a_hash=s_order);
+	} // namespace Image
+
 } // namespace Lettvin
@@ -28,16 +28,28 @@ _____________________________________________________________________________*/
 #include "catch.hpp"               // Testing framework
 
 #include <sstream>
+#include <fstream>
 #include <cstdarg>                 // vararg
 #include <vector>
 #include <string>
 #include <tuple>
+#include <atomic>
+#include <set>
+#include <random>
 
 int32_t debugf (size_t a_debug, const char *fmt, ...);
 
 #include "gg_globals.h"
 #include "gg_utility.h"
+#include "gg_tqueue.h"
+#include "gg_dirent.h"
+#include "gg_anchor.h"
 #include "gg_state.h"
+#include "gg_cache.h"
+
+#include <sys/mman.h>               // shm_open
+#include <sys/stat.h>               // utimensat
+#include <fcntl.h>                  // AT_FDCWD
 
 using namespace std;
 using namespace Lettvin;
@@ -92,13 +104,343 @@ SCENARIO ("Test gg_utility functions")
 			}
 		}
 	}
+	GIVEN ("An FdBudget")
+	{
+		FdBudget budget;
+		THEN ("The budget stops at its limit and recovers on release")
+		{
+			budget.reserve (budget.limit () + 64 - 3);
+			size_t limit{budget.limit ()};
+			REQUIRE (limit > 0);
+			for (size_t i=0; i < limit; ++i)
+			{
+				REQUIRE (budget.try_acquire ());
+			}
+			REQUIRE (!budget.try_acquire ());
+			budget.release ();
+			REQUIRE (budget.try_acquire ());
+			for (size_t i=0; i < limit; ++i)
+			{
+				budget.release ();
+			}
+			REQUIRE (budget.used () == 0);
+		}
+	}
 }
 
 //______________________________________________________________________________
 SCENARIO ("Test gg_tqueue classes and functions")
 {
+	GIVEN ("A WorkStealing pool expanding a binary tree of tasks")
+	{
+		THEN ("Every task is run exactly once and the pool terminates")
+		{
+			for (size_t workers=1; workers < 5; ++workers)
+			{
+				WorkStealing<size_t> pool (workers);
+				atomic<size_t> visited{0};
+				pool (1, [&pool, &visited] (size_t a_worker, size_t& a_node)
+				{
+					++visited;
+					if (a_node < 1024)
+					{
+						pool.push (a_worker, 2 * a_node);
+						pool.push (a_worker, 2 * a_node + 1);
+					}
+				});
+				REQUIRE (visited == 2047);
+			}
+		}
+	}
 }
 
+//______________________________________________________________________________
+SCENARIO ("Test gg_dirent classes and functions")
+{
+	GIVEN ("A DirReader on the test directory")
+	{
+		DirReader dir ("test");
+		THEN ("Entries are classified without . and ..")
+		{
+			REQUIRE (dir.is_open ());
+			set<string> names;
+			const char* name{nullptr};
+			uint8_t type{DT_UNKNOWN};
+			while (dir.next (name, type))
+			{
+				REQUIRE (type == DT_REG);
+				names.insert (name);
+			}
+			REQUIRE (names == set<string>{"TCI2", "TCL2", "tci2", "tcl2"});
+			REQUIRE (DirReader::classify (AT_FDCWD, "test", DT_UNKNOWN) == DT_DIR);
+		}
+	}
+	GIVEN ("A chain of Directory nodes")
+	{
+		THEN ("Paths are materialized from the arenas on demand")
+		{
+			FdBudget budget;
+			auto root{new Directory (nullptr, ".")};
+			size_t offset{root->add ("test")};
+			auto test{new Directory (root, root->name (offset))};
+			root->release ();   // test retains root
+			DirReader reader ("test");
+			test->adopt (reader.detach (), budget);
+			REQUIRE (test->fd () >= 0);
+			REQUIRE (budget.used () == 1);
+
+			string path, scratch;
+			test->path (path, "tci2");
+			REQUIRE (path == "./test/tci2");
+			const char* name{"tci2"};
+			REQUIRE (test->at (name, scratch) == test->fd ());
+			REQUIRE (string (name) == "tci2");
+			test->release ();
+			REQUIRE (budget.used () == 0);
+
+			// The filesystem root gets no second separator.
+			auto top{new Directory (nullptr, "/")};
+			top->path (path, "etc");
+			REQUIRE (path == "/etc");
+			top->release ();
+		}
+	}
+	GIVEN ("A DirReader on a regular file")
+	{
+		DirReader dir ("test/tci2");
+		THEN ("It does not open")
+		{
+			REQUIRE (!dir.is_open ());
+			REQUIRE (dir.error () == ENOTDIR);
+		}
+	}
+}
+
+//______________________________________________________________________________
+SCENARIO ("Test gg_anchor classes and functions")
+{
+	GIVEN ("Random contents and first-letter sets of many sizes")
+	{
+		mt19937 random (42);
+		string contents (4099, ' ');
+		for (auto& c:contents) c = static_cast<char> (random ());
+
+		THEN ("Every supported kernel agrees with find_first_of")
+		{
+			const Anchors::Kernel kernels[]{
+				Anchors::AUTOMATIC, Anchors::MEMCHR, Anchors::SCALAR,
+				Anchors::EQUAL_SSE2, Anchors::EQUAL_AVX2,
+				Anchors::SHUFTI_SSSE3, Anchors::SHUFTI_AVX2};
+			for (size_t size:{0, 1, 2, 3, 4, 9, 17, 40})
+			{
+				string set;
+				for (size_t i=0; i < size; ++i)
+				{
+					set += static_cast<char> (random ());
+				}
+				string_view view (contents);
+				for (auto kernel:kernels)
+				{
+					if (!Anchors::supported (kernel)) continue;
+					if (kernel == Anchors::MEMCHR && size > 1) continue;
+					if (kernel >= Anchors::EQUAL_SSE2 &&
+						kernel <= Anchors::EQUAL_AVX2 && size > 3) continue;
+					Anchors anchors (set, kernel);
+					INFO ("kernel " << Anchors::name (kernel) << " size " << size);
+					for (size_t from=0; from < contents.size (); from += 37)
+					{
+						for (size_t count:{from + 5, from + 70, contents.size ()})
+						{
+							count = min (count, contents.size ());
+							size_t expect{view.substr (0, count).find_first_of (set, from)};
+							REQUIRE (anchors.find (contents.data (), from, count) == expect);
+						}
+					}
+				}
+			}
+		}
+	}
+
+	GIVEN ("Random contents and sets of first byte pairs")
+	{
+		mt19937 random (43);
+		string contents (4099, ' ');
+		for (auto& c:contents) c = "abcdefgh"[random () % 8] ^ (random () % 4 ? 0 : 0x20);
+
+		THEN ("Every supported kernel finds the first allowed pair")
+		{
+			for (size_t size:{1, 2, 5, 30, 200})
+			{
+				set<pair<uint8_t, uint8_t>> allowed;
+				while (allowed.size () < size)
+				{
+					allowed.emplace (contents[random () % contents.size ()],
+							random () % 3 ? contents[random () % contents.size ()]
+							: static_cast<char> (random ()));
+				}
+				auto expect = [&] (size_t a_from, size_t a_count)
+				{
+					for (size_t at=a_from; at + 1 < a_count; ++at)
+					{
+						if (allowed.count ({contents[at], contents[at + 1]})) return at;
+					}
+					return Pairs::npos;
+				};
+				for (auto kernel:{Anchors::AUTOMATIC, Anchors::SCALAR,
+						Anchors::SHUFTI_SSSE3, Anchors::SHUFTI_AVX2})
+				{
+					if (!Anchors::supported (kernel)) continue;
+					Pairs pairs;
+					for (auto& [first, second]:allowed) pairs.insert (first, second);
+					pairs.prepare (kernel);
+					INFO ("kernel " << Anchors::name (kernel) << " size " << size);
+					for (size_t from=0; from < contents.size (); from += 37)
+					{
+						for (size_t count:{from + 1, from + 6, from + 70, contents.size ()})
+						{
+							count = min (count, contents.size ());
+							REQUIRE (pairs.find (contents.data (), from, count) ==
+									expect (from, count));
+						}
+					}
+				}
+			}
+		}
+	}
+}
+
+//______________________________________________________________________________
+namespace
+{
+	//CCCCCCCCCCCCCCCCCCCCCCCCCCCCCCCCCCCCCCCCCCCCCCCCCCCCCCCCCCCCCCCCCCCCCCCCCC
+	/// @brief restore the query globals a test changes, even when it fails
+	struct Globals
+	{
+		Globals () = default;
+		Globals (const Globals&) = delete;
+		Globals& operator= (const Globals&) = delete;
+		~Globals ()
+		{
+			s_budget    = m_budget;
+			s_shift     = m_shift;
+			s_manber    = m_manber;
+			s_noreject  = m_noreject;
+			s_caseless  = m_caseless;
+			s_frequency = m_frequency;
+			s_firsts    = m_firsts;
+			s_reject    = m_reject;
+			s_accept    = m_accept;
+		}
+
+		vsv_t                    m_accept   {s_accept};
+		vsv_t                    m_reject   {s_reject};
+		string                   m_firsts   {s_firsts};
+		array<uint32_t, 256>     m_frequency{s_frequency};
+		bool                     m_caseless {s_caseless};
+		bool                     m_noreject {s_noreject};
+		size_t                   m_manber   {s_manber};
+		size_t                   m_shift    {s_shift};
+		size_t                   m_budget   {s_budget};
+	}; // Globals
+
+	//--------------------------------------------------------------------------
+	/// @brief a_size random letters from a_alphabet
+	string
+	word (mt19937& a_random, const string& a_alphabet, size_t a_size)
+	//--------------------------------------------------------------------------
+	{
+		string str;
+		while (str.size () < a_size) str += a_alphabet[a_random () % a_alphabet.size ()];
+		return str;
+	} // word
+
+	//--------------------------------------------------------------------------
+	/// @brief set s_accept and s_reject to distinct random words
+	///
+	/// Words are a_shortest plus up to a_spread - 1 letters long.
+	/// Distinct under s_caseless: the planes keep only the last id of a
+	/// duplicate.  The globals view the returned strings.
+	vs_t
+	query (
+			mt19937& a_random, const string& a_alphabet,
+			size_t a_accepts, size_t a_rejects,
+			size_t a_shortest, size_t a_spread)
+	//--------------------------------------------------------------------------
+	{
+		vs_t strings;
+		set<string> distinct;
+		while (strings.size () < a_accepts + a_rejects)
+		{
+			string str{word (a_random, a_alphabet, a_shortest + a_random () % a_spread)};
+			string key{str};
+			if (s_caseless) for (auto& c:key) c = tolower (c);
+			if (distinct.insert (key).second) strings.push_back (str);
+		}
+		s_firsts.clear ();
+		s_accept = vsv_t{""};
+		s_reject = vsv_t{""};
+		s_noreject = !a_rejects;
+		for (size_t i=0; i < a_accepts; ++i) s_accept.emplace_back (strings[i]);
+		for (size_t i=0; i < a_rejects; ++i) s_reject.emplace_back (strings[a_accepts + i]);
+		return strings;
+	} // query
+
+	//--------------------------------------------------------------------------
+	/// @brief insert the query's a_strings into a_table under their ids
+	void
+	insert (Table& a_table, const vs_t& a_strings)
+	//--------------------------------------------------------------------------
+	{
+		size_t accepts{s_accept.size () - 1};
+		for (size_t i=0; i < a_strings.size (); ++i)
+		{
+			i24_t id (i < accepts ? i + 1 : -i24_t (i - accepts + 1));
+			a_table.insert (a_strings[i], id);
+		}
+	} // insert
+
+	//--------------------------------------------------------------------------
+	/// @brief insert the query's a_strings into a_table and seal it
+	void
+	compile (Table& a_table, const vs_t& a_strings)
+	//--------------------------------------------------------------------------
+	{
+		insert (a_table, a_strings);
+		a_table.seal ();
+	} // compile
+
+	//--------------------------------------------------------------------------
+	/// @brief scan a_contents a_chunk anchors at a time with both tables
+	///
+	/// REQUIRE the same verdict, and the same ids when there are no rejects.
+	/// Returns both merged tallies for further checks.
+	pair<Tally, Tally>
+	agree (Table& a_expect, Table& a_actual, const string& a_contents, size_t a_chunk)
+	//--------------------------------------------------------------------------
+	{
+		Tally expect, actual;
+		for (size_t begin=0; begin < a_contents.size (); begin += a_chunk)
+		{
+			size_t rest{a_contents.size () - begin};
+			size_t anchors{min (a_chunk, rest)};
+			size_t count{min (anchors + a_expect.longest (), rest)};
+			Tally one, two;
+			a_expect.scan (a_contents.data () + begin, anchors, count, one);
+			a_actual.scan (a_contents.data () + begin, anchors, count, two);
+			expect.merge (one);
+			actual.merge (two);
+		}
+		INFO ("chunk " << a_chunk);
+
+		REQUIRE (Table::verdict (expect) == Table::verdict (actual));
+		if (s_noreject)
+		{
+			REQUIRE (expect.ids () == actual.ids ());
+		}
+		return {expect, actual};
+	} // agree
+} // namespace
+
 //______________________________________________________________________________
 SCENARIO ("Test gg_state classes and functions")
 {
@@ -246,6 +588,635 @@ SCENARIO ("Test gg_state classes and functions")
 		}
 		// TODO(insert, dump, load, and track)
 	}
+
+	GIVEN ("A string straddling the boundary between two chunks")
+	{
+		THEN ("Overlapping chunk scans merge to the whole-file verdict")
+		{
+			auto accept{s_accept};
+			s_accept = vsv_t{"", "needle"};
+
+			Table table;
+			table.insert ("needle", 1);
+			REQUIRE (table.longest () == 6);
+
+			string contents (64, 'x');
+			contents.replace (29, 6, "needle");
+			REQUIRE (table.search (contents.data (), contents.size ()));
+
+			for (size_t chunk=1; chunk < contents.size (); ++chunk)
+			{
+				Tally merged;
+				for (size_t begin=0; begin < contents.size (); begin += chunk)
+				{
+					Tally tally;
+					size_t rest{contents.size () - begin};
+					size_t anchors{min (chunk, rest)};
+					size_t count{min (anchors + table.longest (), rest)};
+					table.scan (contents.data () + begin, anchors, count, tally);
+					merged.merge (tally);
+				}
+				INFO ("chunk " << chunk);
+				REQUIRE (Table::verdict (merged));
+			}
+			s_accept = accept;
+		}
+	}
+
+	GIVEN ("More strings than fit in 256 state planes")
+	{
+		THEN ("Every string is still found")
+		{
+			auto accept{s_accept};
+			auto firsts{s_firsts};
+
+			Table table;
+			vs_t strings;
+			for (size_t index=1; index <= 64; ++index)
+			{
+				string str{fmt::format ("q{:03d}abcdefgh", index)};
+				strings.push_back (str);
+				table.insert (str, index);
+			}
+			REQUIRE (table.size () > 256);
+			table.seal ();
+
+			for (size_t index=1; index <= strings.size (); ++index)
+			{
+				s_accept = vsv_t{"", strings[index - 1]};
+				string contents{"xx" + strings[index - 1] + "xx"};
+				Tally tally;
+				table.scan (contents.data (), contents.size (),
+						contents.size (), tally);
+				INFO ("string " << strings[index - 1]);
+				REQUIRE (tally.accepted (index));
+			}
+			s_firsts = firsts;
+			s_accept = accept;
+		}
+	}
+
+	GIVEN ("Variants sharing a suffix and a set index")
+	{
+		THEN ("Minimization merges their planes and still finds them")
+		{
+			auto accept{s_accept};
+			auto firsts{s_firsts};
+			s_accept = vsv_t{"", "walking"};
+
+			Table table;
+			size_t setindex{table.insert ("walking", 1)};
+			table.insert ("talking", 1, setindex);
+			table.insert ("balking", 1, setindex);
+			size_t before{table.size ()};
+			table.seal ();
+			REQUIRE (table.size () < before - 10);
+
+			for (string contents:{"a talking b", "balkin walkin", "xbalking"})
+			{
+				Tally tally;
+				table.scan (contents.data (), contents.size (),
+						contents.size (), tally);
+				INFO ("contents " << contents);
+				REQUIRE (tally.accepted (1) ==
+						(contents.find ("king") != string::npos));
+			}
+			s_firsts = firsts;
+			s_accept = accept;
+		}
+	}
+
+	GIVEN ("Strings whose rarest byte is not the first")
+	{
+		THEN ("Rare-byte anchored chunks find what first letters find")
+		{
+			auto accept{s_accept};
+			auto firsts{s_firsts};
+			s_accept = vsv_t{"", "the quiz", "sizzle", "tax"};
+
+			Table first, rare;
+			for (auto* table:{&first, &rare})
+			{
+				table->insert ("the quiz", 1);
+				table->insert ("sizzle", 2);
+				table->insert ("tax", 3);
+			}
+			rare.seal ();
+
+			string contents{"a the quiz; sizzles and taxes. the quiz sizz"};
+			Tally expect;
+			first.scan (contents.data (), contents.size (),
+					contents.size (), expect);
+			for (size_t chunk=1; chunk <= contents.size (); ++chunk)
+			{
+				Tally merged;
+				for (size_t begin=0; begin < contents.size (); begin += chunk)
+				{
+					Tally tally;
+					size_t rest{contents.size () - begin};
+					size_t anchors{min (chunk, rest)};
+					size_t count{min (anchors + rare.longest (), rest)};
+					rare.scan (contents.data () + begin, anchors, count, tally);
+					merged.merge (tally);
+				}
+				INFO ("chunk " << chunk);
+				REQUIRE (merged.ids () == expect.ids ());
+			}
+			s_firsts = firsts;
+			s_accept = accept;
+		}
+	}
+
+	GIVEN ("Long strings ending in unique literal tails")
+	{
+		THEN ("Comparing tails finds what the FSM finds")
+		{
+			auto accept{s_accept};
+			auto firsts{s_firsts};
+			auto caseless{s_caseless};
+			for (bool insensitive:{true, false})
+			{
+				s_caseless = insensitive;
+				s_accept = vsv_t{"", "permission is hereby granted",
+					"copyright notice", "tice", "persistent"};
+
+				Table restart, sealed;
+				for (auto* table:{&restart, &sealed})
+				{
+					table->insert ("permission is hereby granted", 1);
+					table->insert ("copyright notice", 2);
+					table->insert ("tice", 3);
+					table->insert ("persistent", 4);
+				}
+				sealed.seal ();
+
+				for (string contents:{
+						"Permission is hereby granted, free",
+						"permission is hereby grante",
+						"xpermission is hereby granted",
+						"the copyright NOTICE: persistent",
+						"copyright notic copyright notice",
+						"PERMISSION IS HEREBY GRANTEDpersisten"})
+				{
+					Tally expect, actual;
+					restart.scan (contents.data (), contents.size (),
+							contents.size (), expect);
+					sealed.scan (contents.data (), contents.size (),
+							contents.size (), actual);
+					INFO ("contents " << contents << " caseless " << insensitive);
+					REQUIRE (expect.ids () == actual.ids ());
+				}
+			}
+			s_caseless = caseless;
+			s_firsts = firsts;
+			s_accept = accept;
+		}
+	}
+
+	GIVEN ("A buffer large enough for interleaved streams")
+	{
+		THEN ("Every stream count finds what one stream finds")
+		{
+			auto accept{s_accept};
+			auto firsts{s_firsts};
+			auto streams{s_streams};
+			s_accept = vsv_t{"", "needle", "haystack", "absent"};
+
+			Table table;
+			table.insert ("needle", 1);
+			table.insert ("haystack", 2);
+			table.insert ("absent", 3);
+			table.seal ();
+
+			mt19937 random (7);
+			string contents (1 << 16, ' ');
+			for (auto& c:contents) c = "abcdehlnsty "[random () % 12];
+			for (size_t at:{size_t (0), size_t (8190), size_t (16381),
+					contents.size () - 6})
+			{
+				contents.replace (at, 6, at & 1 ? "needle" : "haysta");
+			}
+			contents.replace (32766, 8, "haystack");
+
+			for (size_t count:{1, 2, 4, 8})
+			{
+				s_streams = count;
+				for (size_t chunk:{size_t (4096), size_t (40000), contents.size ()})
+				{
+					Tally merged;
+					for (size_t begin=0; begin < contents.size (); begin += chunk)
+					{
+						Tally tally;
+						size_t rest{contents.size () - begin};
+						size_t anchors{min (chunk, rest)};
+						size_t bytes{min (anchors + table.longest (), rest)};
+						table.scan (contents.data () + begin, anchors, bytes, tally);
+						merged.merge (tally);
+					}
+					INFO ("streams " << count << " chunk " << chunk);
+					REQUIRE (merged.ids () == vector<i24_t>{0, 1, 2});
+				}
+			}
+			s_streams = streams;
+			s_firsts = firsts;
+			s_accept = accept;
+		}
+	}
+
+	GIVEN ("Random small sets of accept and reject strings")
+	{
+		THEN ("The Shift-And engine agrees with the planes")
+		{
+			Globals globals;
+			s_frequency.fill (1);   // keep first-letter anchoring
+
+			mt19937 random (11);
+			for (size_t trial=0; trial < 200; ++trial)
+			{
+				INFO ("trial " << trial);
+				s_caseless = trial & 1;
+				size_t accepts{1 + random () % 4}, rejects{random () % 2};
+				vs_t strings{query (random, "abcAB", accepts, rejects, 1, trial < 100 ? 8 : 24)};
+
+				Table planes, shifts;
+				for (size_t bits:{0, 128})
+				{
+					s_shift = bits;
+					compile (bits ? shifts : planes, strings);
+				}
+				REQUIRE (planes.bits () == 0);
+				REQUIRE (shifts.bits () != 0);
+
+				string contents{word (random, "abcAB", 300)};
+				for (size_t chunk:{size_t (7), size_t (64), contents.size ()})
+				{
+					agree (planes, shifts, contents, chunk);
+				}
+			}
+		}
+	}
+
+	GIVEN ("Random large sets of accept and reject strings")
+	{
+		THEN ("The Wu-Manber engine agrees with the planes")
+		{
+			Globals globals;
+
+			mt19937 random (17);
+			for (size_t trial=0; trial < 12; ++trial)
+			{
+				INFO ("trial " << trial);
+				// The last trials are large enough for 3-byte blocks.
+				bool large{trial >= 9};
+				s_caseless = trial & 1;
+				size_t accepts{large ? 256 + random () % 1000 : 64 + random () % 190};
+				size_t rejects{trial % 3 == 2 ? size_t (1) : size_t (0)};
+				vs_t strings{query (random, "abcdeAB", accepts, rejects, large ? 6 : 4, 8)};
+
+				Table planes, manbers;
+				for (size_t count:{0, 64})
+				{
+					s_manber = count;
+					compile (count ? manbers : planes, strings);
+				}
+				REQUIRE (!planes.manber ());
+				REQUIRE (manbers.manber ());
+
+				string contents{word (random, "abcdeAB", 4000)};
+				for (size_t chunk:{size_t (13), size_t (512), contents.size ()})
+				{
+					Tally expect{agree (planes, manbers, contents, chunk).first};
+					if (s_noreject)
+					{
+						REQUIRE (expect.accepts () > 1);
+					}
+				}
+			}
+		}
+	}
+
+	GIVEN ("Random sets of strings over a small memory budget")
+	{
+		THEN ("The double-array trie agrees with the planes")
+		{
+			Globals globals;
+			size_t budget{s_budget};
+			s_manber = s_shift = 0;
+
+			mt19937 random (19);
+			for (size_t trial=0; trial < 40; ++trial)
+			{
+				INFO ("trial " << trial);
+				s_caseless = trial & 1;
+				size_t accepts{1 + random () % 40}, rejects{random () % 2};
+				vs_t strings{query (random, "abcdAB", accepts, rejects, 2, 6)};
+
+				Table planes, sparse;
+				for (size_t bytes:{budget, size_t (0)})
+				{
+					s_budget = bytes;
+					compile (bytes ? planes : sparse, strings);
+				}
+				REQUIRE (!planes.sparse ());
+				REQUIRE (sparse.sparse ());
+				REQUIRE (sparse.size () < planes.size ());
+
+				string contents{word (random, "abcdAB", 600)};
+				for (size_t chunk:{size_t (11), contents.size ()})
+				{
+					agree (planes, sparse, contents, chunk);
+				}
+			}
+		}
+	}
+
+	GIVEN ("Random sets of strings dumped to an image")
+	{
+		THEN ("The loaded image agrees with the compiled table")
+		{
+			Globals globals;
+			size_t budget{s_budget}, shift{s_shift};
+			const char* image{"gg_test.table"};
+
+			// Rewrite a uint32_t of section a_part and fix the checksum,
+			// as anyone able to write the image could (see Table::load).
+			auto forge = [&] (Image::Part a_part, size_t a_at, uint32_t a_value)
+			{
+				fstream file (image, ios::in | ios::out | ios::binary);
+				string bytes{istreambuf_iterator<char> (file), {}};
+				Image::Header header;
+				memcpy (&header, bytes.data (), sizeof (header));
+				const Image::Section& part{header.m_parts[a_part]};
+				if (part.m_bytes < a_at + sizeof (a_value)) return false;
+				memcpy (&bytes[part.m_offset + a_at], &a_value, sizeof (a_value));
+				uint64_t hash{Image::s_order};
+				for (auto& section:header.m_parts)
+				{
+					hash = Image::checksum (bytes.data () + section.m_offset,
+							section.m_bytes, hash);
+				}
+				memcpy (&bytes[offsetof (Image::Header, m_checksum)], &hash, sizeof (hash));
+				file.seekp (0);
+				file.write (bytes.data (), bytes.size ());
+				return true;
+			};
+
+			/// Sees whether a refused load left anything behind.
+			struct Probe : Table
+			{
+				bool pristine () const
+				{
+					return m_tail.empty () && m_tails.empty () && m_strings.empty ();
+				}
+			};
+			size_t forged{0}, harmless{0};
+
+			mt19937 random (23);
+			for (size_t trial=0; trial < 24; ++trial)
+			{
+				INFO ("trial " << trial);
+				s_caseless = trial & 1;
+				s_budget = trial % 3 ? budget : 0;      ///< some sparse
+				s_shift = trial % 4 ? 0 : shift;        ///< some Shift-And
+				s_manber = 0;
+				size_t accepts{1 + random () % 30}, rejects{random () % 2};
+				vs_t strings{query (random, "abcdAB", accepts, rejects, 2, 6)};
+
+				Table compiled, loaded;
+				Probe unsealed;
+				insert (compiled, strings);
+				REQUIRE (!compiled.dump (image));
+				compiled.seal ();
+				REQUIRE (compiled.dump (image, "trial"));
+				string saved{s_firsts};
+				s_firsts.clear ();
+				REQUIRE (loaded.load (image));
+				REQUIRE (s_firsts == saved);
+				REQUIRE (loaded.sparse () == compiled.sparse ());
+				REQUIRE (loaded.bits () == compiled.bits ());
+				REQUIRE (loaded.dump (image));   ///< the mapped image, as is
+
+				string contents{word (random, "abcdAB", 600)};
+				auto [expect, actual]{agree (compiled, loaded, contents, contents.size ())};
+				REQUIRE (expect.m_rejected == actual.m_rejected);
+
+				// Other patterns, or a changed byte, refuse the image.
+				s_accept.emplace_back ("zzzz");
+				REQUIRE (!unsealed.load (image));
+				s_accept.pop_back ();
+				{
+					fstream file (image, ios::in | ios::out | ios::binary);
+					file.seekp (4096 + random () % 64);
+					file.put ('\x7f');
+				}
+				REQUIRE (!unsealed.load (image));
+
+				// Forged states or groups are refused even though the
+				// checksum is right (a harmless forgery still loads).
+				REQUIRE (compiled.dump (image, "trial"));
+				if (forge (Image::TAIL, 0, 0))      ///< plane 0 is no head
+				{
+					Table unchanged;
+					REQUIRE (unchanged.load (image));
+					++harmless;
+				}
+				REQUIRE (forge (Image::PLANES, 0, ~uint32_t (0)));
+				REQUIRE (!unsealed.load (image));
+				REQUIRE (compiled.dump (image, "trial"));
+				REQUIRE (forge (Image::GROUPS, sizeof (uint32_t), ~uint32_t (0)));   ///< past MEMBERS
+				REQUIRE (!unsealed.load (image));
+
+				// A tail ending past the planes is refused and, as for
+				// every refusal, the table is left to be compiled.
+				REQUIRE (compiled.dump (image, "trial"));
+				if (forge (Image::TAILS, offsetof (Image::Record, m_state), ~uint32_t (0)))
+				{
+					REQUIRE (!unsealed.load (image));
+					++forged;
+				}
+				REQUIRE (unsealed.pristine ());
+				compile (unsealed, strings);
+				agree (compiled, unsealed, contents, contents.size ());
+			}
+			REQUIRE (harmless);
+			REQUIRE (forged);
+			remove (image);
+		}
+	}
+
+	GIVEN ("Strings where one is a proper infix of another")
+	{
+		THEN ("Sealed single-pass scan finds the same strings as restarting")
+		{
+			auto accept{s_accept};
+			auto firsts{s_firsts};
+			s_accept = vsv_t{"", "abcd", "bc", "cab"};
+
+			Table restart, linked;
+			for (auto* table:{&restart, &linked})
+			{
+				table->insert ("abcd", 1);
+				table->insert ("bc", 2);
+				table->insert ("cab", 3);
+			}
+			linked.seal ();
+			REQUIRE (linked.stride () < restart.stride ());
+			REQUIRE (linked[s_root]['a'].nxt () == restart[s_root]['a'].nxt ());
+
+			for (string contents:{"xabcx", "abcabcd", "ababcd", "cabc", "xyz"})
+			{
+				Tally expect, actual;
+				restart.scan (contents.data (), contents.size (),
+						contents.size (), expect);
+				linked.scan (contents.data (), contents.size (),
+						contents.size (), actual);
+				INFO ("contents " << contents);
+				REQUIRE (expect.ids () == actual.ids ());
+			}
+			s_firsts = firsts;
+			s_accept = accept;
+		}
+
+		THEN ("Sealed planes are numbered breadth-first from the root")
+		{
+			auto accept{s_accept};
+			auto firsts{s_firsts};
+			s_accept = vsv_t{"", "zzzz", "abcd"};
+
+			Table table;
+			table.insert ("zzzz", 1);
+			table.insert ("abcd", 2);
+			table.seal ();
+			REQUIRE (table[s_root]['a'].nxt () == s_root + 1);
+			REQUIRE (table[s_root]['z'].nxt () == s_root + 2);
+			REQUIRE (table[s_root + 1]['b'].nxt () == s_root + 3);
+			REQUIRE (table[s_root + 2]['z'].nxt () == s_root + 4);
+			s_firsts = firsts;
+			s_accept = accept;
+		}
+	}
+}
+
+//______________________________________________________________________________
+SCENARIO ("Test gg_cache classes and functions")
+{
+	GIVEN ("A query cache in a fresh directory")
+	{
+		THEN ("A stored query loads, other queries miss, old files go")
+		{
+			auto accept{s_accept};
+			auto firsts{s_firsts};
+			auto caseless{s_caseless};
+			string dir{"gg_test.cache"};
+			QueryCache cache (dir);
+			REQUIRE (cache.directory () == dir);
+
+			s_accept = vsv_t{"", "alpha", "beta"};
+			s_firsts.clear ();
+			uint64_t key{QueryCache::key ()};
+			Table compiled;
+			compiled.insert ("alpha", 1);
+			compiled.insert ("beta", 2);
+			compiled.seal ();
+			Table missed;
+			REQUIRE (!cache.load (missed));
+			REQUIRE (cache.store (compiled));
+			struct stat st;                     ///< patterns kept private
+			REQUIRE (!stat (dir.c_str (), &st));
+			REQUIRE ((st.st_mode & 0777) == 0700);
+			REQUIRE (!stat (cache.path ().c_str (), &st));
+			REQUIRE ((st.st_mode & 0777) == 0600);
+
+			Table loaded;
+			REQUIRE (cache.load (loaded));
+			string contents{"xx beta yy alpha"};
+			Tally tally;
+			loaded.scan (contents.data (), contents.size (), contents.size (), tally);
+			REQUIRE (Table::verdict (tally));
+
+			s_caseless = !s_caseless;
+			REQUIRE (QueryCache::key () != key);
+			s_caseless = caseless;
+			s_accept.emplace_back ("gamma");
+			REQUIRE (QueryCache::key () != key);
+			s_accept.pop_back ();
+			REQUIRE (QueryCache::key () == key);
+
+			// A file unused for longer than s_age is evicted.
+			struct timespec old[2];
+			old[0].tv_sec = old[1].tv_sec = time (nullptr) - QueryCache::s_age - 60;
+			old[0].tv_nsec = old[1].tv_nsec = 0;
+			REQUIRE (!utimensat (AT_FDCWD, cache.path ().c_str (), old, 0));
+			cache.evict ();
+			Table evicted;
+			REQUIRE (!cache.load (evicted));
+			rmdir (dir.c_str ());
+
+			s_firsts = firsts;
+			s_accept = accept;
+		}
+	}
+
+	GIVEN ("A query published in shared memory")
+	{
+		THEN ("Another user attaches it and sweep spares held segments")
+		{
+			auto accept{s_accept};
+			auto firsts{s_firsts};
+			s_accept = vsv_t{"", "delta", "epsilon", "gg_test shared"};
+			s_firsts.clear ();
+			string contents{"epsilon then delta for gg_test shared"};
+			{
+				Table compiled;
+				compiled.insert ("delta", 1);
+				compiled.insert ("epsilon", 2);
+				compiled.insert ("gg_test shared", 3);
+				compiled.seal ();
+				SharedQuery publisher{0}, user{0};
+				Table attached, early;
+				REQUIRE (!user.attach (early));
+				REQUIRE (publisher.publish (compiled));
+				REQUIRE (publisher.held ());
+				struct stat st;
+				int fd{shm_open (publisher.name ().c_str (), O_RDONLY, 0)};
+				REQUIRE (!fstat (fd, &st));
+				REQUIRE (st.st_uid == geteuid ());
+				REQUIRE ((st.st_mode & 0777) == 0600);   ///< patterns kept private
+				REQUIRE (!SharedQuery{0}.publish (compiled));   ///< one writer
+				REQUIRE (user.attach (attached));
+
+				Tally tally;
+				attached.scan (contents.data (), contents.size (), contents.size (), tally);
+				REQUIRE (Table::verdict (tally));
+
+				// Held (even with no lease left), so not removed.
+				REQUIRE (!SharedQuery::discard (user.name (), 0));
+				Table again;
+				REQUIRE (SharedQuery{0}.attach (again));
+
+				// A segment of the same name owned by another user is not
+				// trusted (only root can arrange that here).
+				if (!geteuid () && !fchown (fd, 1, 1))
+				{
+					Table foreign;
+					REQUIRE (!SharedQuery{0}.attach (foreign));
+					REQUIRE (!fchown (fd, 0, 0));
+				}
+				close (fd);
+			}
+			// Released by every user, any query's sweep removes it.
+			SharedQuery released{0};
+			s_accept.emplace_back ("another query");
+			SharedQuery{0}.sweep ();
+			s_accept.pop_back ();
+			REQUIRE (!SharedQuery::discard (released.name (), 0));
+			Table gone;
+			REQUIRE (!released.attach (gone));
+
+			s_firsts = firsts;
+			s_accept = accept;
+		}
+	}
 }
 
 //______________________________________________________________________________
@@ -25,11 +25,14 @@ _____________________________________________________________________________*/
 #pragma once
 
 #include <queue>
+#include <deque>
 #include <vector>
 #include <string>
 
 #include <thread>
 #include <mutex>
+#include <atomic>
+#include <chrono>
 #include <condition_variable>
  
 #include <fmt/printf.h>
@@ -87,6 +90,22 @@ public:
 
 	} // pop (item)
 
+	//--------------------------------------------------------------------------
+	/// @brief pop unless the queue is empty (never waits)
+	bool try_pop (T& a_item)
+	{
+		std::unique_lock<std::mutex> mlock (m_mutex);
+		if (m_queue.empty ())
+		{
+			return false;
+		}
+		a_item = std::move (m_queue.front ());
+		m_queue.pop ();
+		mlock.unlock ();
+		m_full.notify_one ();
+		return true;
+	} // try_pop (item)
+
 	//--------------------------------------------------------------------------
 	void push (const T& a_item)
 	{
@@ -119,6 +138,21 @@ public:
 		m_available.notify_one ();
 	} // push (item) move
 
+	//--------------------------------------------------------------------------
+	/// @brief push unless the queue is full (never waits)
+	bool try_push (T&& a_item)
+	{
+		std::unique_lock<std::mutex> mlock (m_mutex);
+		if (m_queue.size () >= m_maximum)
+		{
+			return false;
+		}
+		m_queue.push (std::move (a_item));
+		mlock.unlock ();
+		m_available.notify_one ();
+		return true;
+	} // try_push (item) move
+
 //------
 private:
 //------
@@ -131,6 +165,129 @@ private:
 
 }; // class ThreadedQueue
 
+//______________________________________________________________________________
+/// @brief per-worker deques with stealing for recursive task distribution
+///
+/// Each worker owns a deque.  The owner pushes and pops at the back (LIFO)
+/// which keeps a depth-first walk cache-warm; idle workers steal from the
+/// front (FIFO) of another worker's deque which takes the oldest, and
+/// typically largest, unexplored subtree.
+/// Termination: m_pending counts tasks pushed but not yet completed.
+/// A task is completed only after its handler returns, so any children it
+/// pushed are already counted.  When m_pending reaches 0 no task exists
+/// anywhere and no running handler can create one; all workers exit.
+template <typename T>
+class WorkStealing
+{
+
+//------
+public:
+//------
+
+	WorkStealing (size_t a_workers=1)
+		: m_deques (a_workers ? a_workers : 1)
+	{
+	}
+
+	//--------------------------------------------------------------------------
+	size_t workers () const { return m_deques.size (); }
+
+	//--------------------------------------------------------------------------
+	/// @brief owner push (also used to seed before operator ())
+	void push (size_t a_worker, T&& a_item)
+	{
+		m_pending.fetch_add (1, std::memory_order_relaxed);
+		auto& deque{m_deques[a_worker % m_deques.size ()]};
+		std::lock_guard<std::mutex> mlock (deque.m_mutex);
+		deque.m_tasks.push_back (std::move (a_item));
+	} // push
+
+	//--------------------------------------------------------------------------
+	/// @brief run a_fun (worker, item) until no tasks remain anywhere.
+	///
+	/// The calling thread is the manager: it seeds, starts the workers,
+	/// and joins them.  a_fun may call push (worker, child) for new tasks.
+	template <typename F>
+	void operator ()(T a_seed, F a_fun)
+	{
+		push (0, std::move (a_seed));
+		vector<thread> threads;
+		for (size_t worker=0; worker < m_deques.size (); ++worker)
+		{
+			threads.emplace_back (
+				thread{
+					[this, worker, &a_fun] ()
+					{
+						T item;
+						size_t idle{0};
+						while (m_pending.load (std::memory_order_acquire))
+						{
+							if (pop (worker, item) || steal (worker, item))
+							{
+								a_fun (worker, item);
+								m_pending.fetch_sub (1, std::memory_order_release);
+								idle = 0;
+							}
+							else if (++idle < 64)
+							{
+								std::this_thread::yield ();
+							}
+							else
+							{
+								std::this_thread::sleep_for (
+									std::chrono::microseconds (50));
+							}
+						}
+					}
+				}
+			);
+		}
+		for (auto& thrd:threads) thrd.join ();
+	} // operator ()()
+
+//------
+private:
+//------
+
+	//--------------------------------------------------------------------------
+	bool pop (size_t a_worker, T& a_item)
+	{
+		auto& deque{m_deques[a_worker]};
+		std::lock_guard<std::mutex> mlock (deque.m_mutex);
+		if (deque.m_tasks.empty ()) return false;
+		a_item = std::move (deque.m_tasks.back ());
+		deque.m_tasks.pop_back ();
+		return true;
+	} // pop
+
+	//--------------------------------------------------------------------------
+	bool steal (size_t a_worker, T& a_item)
+	{
+		for (size_t N=m_deques.size (), n=1; n < N; ++n)
+		{
+			auto& deque{m_deques[(a_worker + n) % N]};
+			std::unique_lock<std::mutex> mlock (deque.m_mutex, std::try_to_lock);
+			if (!mlock.owns_lock () || deque.m_tasks.empty ()) continue;
+			a_item = std::move (deque.m_tasks.front ());
+			deque.m_tasks.pop_front ();
+			return true;
+		}
+		return false;
+	} // steal
+
+	//--------------------------------------------------------------------------
+	/// Each deque is on its own cache line to avoid false sharing of mutexes.
+	struct alignas (64) Deque
+	{
+		std::mutex    m_mutex;
+		std::deque<T> m_tasks;
+	};
+
+	vector<Deque>       m_deques;
+	std::atomic<size_t> m_pending{0};
+
+}; // class WorkStealing
+
 #ifdef MAIN
 //______________________________________________________________________________
 /// Demonstration use of ThreadedQueue
@@ -27,10 +27,14 @@ _____________________________________________________________________________*/
 
 #include <sys/types.h>
 #include <sys/stat.h>
+#include <sys/resource.h>
+#include <sys/mman.h>
 #include <fcntl.h>
 #include <unistd.h>
 #include <stdarg.h>
 
+#include <thread>
+
 #include <fmt/format.h>
 
 #include "gg_utility.h"
@@ -187,3 +191,133 @@ tokenize (
 	}
 	target.push_back (source.substr (b));
 } // tokenize
+
+//------------------------------------------------------------------------------
+/// @brief aligned_alloc rounded up to a multiple of the alignment
+///
+/// From s_huge bytes the block is aligned and sized to 2MiB and advised
+/// as MADV_HUGEPAGE so khugepaged (or the fault) backs it with huge pages.
+void*
+Lettvin::
+aligned (size_t a_align, size_t a_bytes)
+//------------------------------------------------------------------------------
+{
+	static const size_t huge{size_t (1) << 21};
+	if (s_huge && a_bytes >= s_huge && a_align < huge) a_align = huge;
+	size_t bytes{((a_bytes + a_align - 1) / a_align) * a_align};
+	void* pointer{aligned_alloc (a_align, bytes ? bytes : a_align)};
+#ifdef MADV_HUGEPAGE
+	if (pointer && a_align == huge) madvise (pointer, bytes, MADV_HUGEPAGE);
+#endif
+	return pointer;
+} // aligned
+
+//------------------------------------------------------------------------------
+/// @brief map a_bytes of a_fd read-only and shared; a_fd may be closed after
+bool
+Lettvin::Region::
+map (int a_fd, size_t a_bytes)
+//------------------------------------------------------------------------------
+{
+	close ();
+	void* data{mmap (nullptr, a_bytes, PROT_READ, MAP_SHARED, a_fd, 0)};
+	if (data == MAP_FAILED) return false;
+	m_data = static_cast<const char*> (data);
+	m_size = a_bytes;
+	return true;
+} // map
+
+//------------------------------------------------------------------------------
+void
+Lettvin::Region::
+close ()
+//------------------------------------------------------------------------------
+{
+	if (m_data) munmap (const_cast<char*> (m_data), m_size);
+	m_data = nullptr;
+	m_size = 0;
+} // close
+
+//------------------------------------------------------------------------------
+Lettvin::FdBudget::
+FdBudget (size_t a_reserve)
+//------------------------------------------------------------------------------
+{
+	// Raise the soft limit as far as the hard limit allows.
+	struct rlimit rl;
+	if (!getrlimit (RLIMIT_NOFILE, &rl))
+	{
+		static const rlim_t ceiling{1 << 16};
+		rlim_t want{rl.rlim_max == RLIM_INFINITY ? ceiling : rl.rlim_max};
+		if (want > ceiling) want = ceiling;
+		if (want > rl.rlim_cur)
+		{
+			rl.rlim_cur = want;
+			setrlimit (RLIMIT_NOFILE, &rl);
+			getrlimit (RLIMIT_NOFILE, &rl);
+		}
+		m_rlimit = rl.rlim_cur;
+	}
+	reserve (a_reserve);
+} // ctor
+
+//------------------------------------------------------------------------------
+void
+Lettvin::FdBudget::
+reserve (size_t a_reserve)
+//------------------------------------------------------------------------------
+{
+	m_limit = m_rlimit > 2 * a_reserve ? m_rlimit - a_reserve : m_rlimit / 2;
+	if (!m_limit) m_limit = 1;
+} // reserve
+
+//------------------------------------------------------------------------------
+bool
+Lettvin::FdBudget::
+try_acquire ()
+//------------------------------------------------------------------------------
+{
+	return try_acquire (m_limit);
+} // try_acquire
+
+//------------------------------------------------------------------------------
+/// @brief acquire only while fewer than a_ceiling are in use
+bool
+Lettvin::FdBudget::
+try_acquire (size_t a_ceiling)
+//------------------------------------------------------------------------------
+{
+	size_t used{m_used.load (std::memory_order_relaxed)};
+	if (a_ceiling > m_limit) a_ceiling = m_limit;
+	while (used < a_ceiling)
+	{
+		if (m_used.compare_exchange_weak (used, used + 1,
+					std::memory_order_acquire,
+					std::memory_order_relaxed))
+		{
+			return true;
+		}
+	}
+	return false;
+} // try_acquire
+
+//------------------------------------------------------------------------------
+void
+Lettvin::FdBudget::
+acquire ()
+//------------------------------------------------------------------------------
+{
+	while (!try_acquire ())
+	{
+		std::this_thread::yield ();
+	}
+} // acquire
+
+//------------------------------------------------------------------------------
+void
+Lettvin::FdBudget::
+release ()
+//------------------------------------------------------------------------------
+{
+	m_used.fetch_sub (1, std::memory_order_release);
+} // release
@@ -28,6 +28,8 @@ _____________________________________________________________________________*/
 #include <string>
 #include <cstdarg>
 #include <string_view>
+#include <atomic>
+#include <cstdlib>
 
 #include "gg_globals.h"
 #include "gg_version.h"
@@ -82,4 +84,102 @@ namespace Lettvin
 			vs_t& target,
 			string a_source,
 			string separator=" ");
+
+	//CCCCCCCCCCCCCCCCCCCCCCCCCCCCCCCCCCCCCCCCCCCCCCCCCCCCCCCCCCCCCCCCCCCCCCCCCC
+	/// @brief lock-free budget of open file descriptors shared by threads
+	///
+	/// The soft RLIMIT_NOFILE is raised to the hard limit and a reserve is
+	/// kept back for stdio, directory streams and the like.
+	/// acquire yields while the budget is exhausted; release after close.
+	//__________________________________________________________________________
+	class
+	FdBudget
+	{
+	//------
+	public:
+	//------
+		FdBudget (size_t a_reserve=64);
+		void   reserve     (size_t a_reserve);
+		size_t limit       () const { return m_limit; }
+		size_t used        () const { return m_used.load (); }
+		bool   try_acquire ();
+		bool   try_acquire (size_t a_ceiling);
+		void   acquire     ();
+		void   release     ();
+	//------
+	private:
+	//------
+		size_t         m_rlimit{0};    ///< raised soft RLIMIT_NOFILE
+		size_t         m_limit {0};    ///< descriptors permitted in flight
+		atomic<size_t> m_used  {0};    ///< descriptors now in flight
+	}; // class FdBudget
+
+	//--------------------------------------------------------------------------
+	/// @brief aligned_alloc rounded up; s_huge bytes or more go on 2MiB pages
+	void*
+	aligned (size_t a_align, size_t a_bytes);
+	//--------------------------------------------------------------------------
+
+	//CCCCCCCCCCCCCCCCCCCCCCCCCCCCCCCCCCCCCCCCCCCCCCCCCCCCCCCCCCCCCCCCCCCCCCCCCC
+	/// @brief read-only shared mapping of a descriptor, unmapped when done
+	//__________________________________________________________________________
+	class
+	Region
+	{
+	//------
+	public:
+	//------
+		Region () = default;
+		Region (const Region&) = delete;
+		Region& operator= (const Region&) = delete;
+		~Region () { close (); }
+
+		bool        map   (int a_fd, size_t a_bytes);
+		void        close ();
+		void        swap  (Region& a_other)
+		{
+			std::swap (m_data, a_other.m_data);
+			std::swap (m_size, a_other.m_size);
+		}
+		const char* data  () const { return m_data; }
+		size_t      size  () const { return m_size; }
+	//------
+	private:
+	//------
+		const char* m_data{nullptr};   ///< first mapped byte
+		size_t      m_size{0};         ///< mapped bytes
+	}; // class Region
+
+	//CCCCCCCCCCCCCCCCCCCCCCCCCCCCCCCCCCCCCCCCCCCCCCCCCCCCCCCCCCCCCCCCCCCCCCCCCC
+	/// @brief allocator aligning vector contents to A (default cache line)
+	///
+	/// Allocations of s_huge bytes or more are aligned and sized to 2MiB
+	/// and advised onto transparent huge pages, so a large table costs
+	/// one TLB entry per 2MiB rather than per 4KiB (see gg_bench tlb).
+	//__________________________________________________________________________
+	template<typename T, size_t A=64>
+	struct
+	Aligned
+	{
+		typedef T value_type;
+		template<typename U> struct rebind { typedef Aligned<U, A> other; };
+
+		Aligned () = default;
+		template<typename U> Aligned (const Aligned<U, A>&) {}
+
+		T* allocate (size_t a_count)
+		{
+			if (auto pointer = aligned (A, a_count * sizeof (T)))
+			{
+				return static_cast<T*> (pointer);
+			}
+			throw bad_alloc ();
+		}
+		void deallocate (T* a_pointer, size_t) { free (a_pointer); }
+
+		template<typename U>
+		bool operator== (const Aligned<U, A>&) const { return true; }
+		template<typename U>
+		bool operator!= (const Aligned<U, A>&) const { return false; }
+	}; // struct Aligned
 }  // namespace Lettvin
@@ -51,7 +51,19 @@ OPTIONS:
     -s, --suppress     # suppress permission denied errors
     -t, --test         # test algorithms (unit and timing)  TODO
     -v, --variant      # enable variant syntax with {} braces
-    -1 -2 ... -8 -9    # threadcount to cpu core ratio (1-9) (deprecate)
+    --pread={bytes}    # read (not mmap) files smaller than this (65536)
+    --chunk={bytes}    # scan files of twice this in parallel chunks (64MiB)
+    --frequency={file} # sample file for byte frequencies (rare anchors)
+    --streams={count}  # interleave 2, 4, or 8 scans of each file (1)
+    --shift={bytes}    # bit-parallel search when strings total this (128)
+    --manber={count}   # block-shift search from this many strings (64)
+    --sparse           # double-array trie (memory per edge, not per state)
+    --budget={bytes}   # double-array trie beyond this many plane bytes (1GiB)
+    --huge={bytes}     # 2MiB pages for planes of this many bytes (2MiB, 0 off)
+    --query-cache={dir} # compiled queries ($GG_CACHE or ~/.cache/gg)
+    --no-query-cache   # always compile; neither load nor store
+    --shared[={secs}]  # share the table in memory with other gg (lease 3600)
+    -1 -2 ... -8 -9    # I/O threadcount to cpu core ratio (1-9)
 
 ACCEPT/REJECT VARIANTS:
     When the --variant option is used
@@ -91,7 +103,8 @@ EXAMPLES:
 
 NOTES:
     Interpreting command-lines:
-        -1 ,,, -9   : -3 if there are 4 cores, gg will have 3*4 = 12 threads
+        -1 ,,, -9   : -3 if there are 4 cores, gg will have 3*4 = 12 I/O threads
+                      and 4 scan threads
         foo1        :    foo1 is accept string
         +foo2       :    foo2 is accept string
         -foo3       :    foo3 is reject string
@@ -187,8 +200,9 @@ This code has been tested on:
 * g++ version 7.1.0
 
 Through experiment (see [-{N}]) it became apparent that
-having more threads than cpu cores yields no advantage.
-This option should be deprecated.
+having more scan threads than cpu cores yields no advantage.
+[-{N}] now multiplies only the I/O threads which open and map files;
+this helps on high-latency mounts such as sshfs.
 
 Contributors are welcome to port this to different systems
 and offer pushes for me to pull.
@@ -232,9 +246,93 @@ This code uses two significant optimizations on string searches:
 
 ### Skipping
 C++ strings have a 'find_first_of' method optimizing skip to a valid initial char.
-
-### Tail comparison (TODO)
+Sealed tables skip with class Anchors instead (gg_anchor.h):
+memchr for one first letter, 16/32-byte compares for two or three,
+and otherwise the nibble-shuffle (shufti) technique with PSHUFB,
+choosing SSE2/SSSE3/AVX2 at runtime with a scalar fallback.
+When every string has two or more bytes, class Pairs skips to the
+first two letters instead: a double shufti looks up each byte in its
+high nibble's bucket and the next byte in that bucket's own tables,
+32 offsets per step.  This matters most for nibble planes, where each
+false anchor costs two dependent lookups per byte it walks.
+
+### Failure links (Aho-Corasick)
+After all strings are inserted, byte-shaped tables are sealed:
+each missing transition is filled from the state of the longest suffix
+which is also a prefix, and outputs of suffix strings are merged in.
+The search then consumes every byte exactly once
+instead of restarting the FSM at each anchor.
+Skipping is used only while the FSM is in its root state.
+Nibble-shaped tables still restart at each anchor.
+
+### Minimization
+Sealing merges states which no input can tell apart.
+Variants share one set index, so their common suffixes
+collapse into a single chain of planes (as in a DAWG).
+With -d the plane counts before and after are reported.
+
+### Byte classes
+Sealing also merges bytes which behave identically in every plane
+into one class and narrows planes to one column per class.
+A 256-byte lookup maps each input byte to its column,
+so the search keeps one table lookup per byte
+while the table approaches the size of nibble planes.
+
+### Rare-byte anchoring
+Strings beginning with common letters make skipping to first letters
+nearly useless (more so caseless, where both cases are first letters).
+When sealed, each string is also anchored on its rarest byte,
+judged by a built-in table of byte frequencies in English and source
+code (or a sample given by --frequency={file}).
+If that is expected to find at most half as many candidates,
+the search jumps to rare bytes and walks the FSM from each implied start.
+
+### Shift-And
+When all strings total at most 128 bytes (--shift={bytes})
+they are laid end to end in one 64 or 128 bit word and matched
+bit-parallel (Shift-And, the dual of Shift-Or): one shift, OR and AND
+per byte with no planes at all.  Skipping to first letters still applies
+whenever no string is partly matched.
+
+### Wu-Manber
+Skipping to first letters is useless for hundreds of strings: nearly
+every byte is some string's first letter.  From 64 strings
+(--manber={count}, 0 never) all of 4 or more bytes, a window of the
+shortest length slides over the text and its last 2 (or, from 256
+strings, 3) bytes index a table of how far it may safely move.
+Only windows whose block ends some string's prefix are verified,
+first by two leading bytes and then by a full (caseless) compare.
+
+### Double-array trie
+Dense planes cost 256 transitions per state: 100k strings need gigabytes.
+With --sparse, or once the planes would exceed --budget={bytes} (1GiB),
+strings go into a double-array trie instead (gg_darray.h): state s has
+its edge on byte c at slot base[s]+c when check[base[s]+c] is s, so
+memory follows the real edges and a transition is still O(1).
+Like nibble planes it restarts at each anchor (first two letters).
+
+### Page locality
+Most transitions of a scan stay within a few bytes of the root.
+After minimizing, planes are renumbered breadth-first from the root so
+those shallow states are contiguous rather than scattered by insertion
+order, and tables of --huge={bytes} (2MiB) or more are advised onto
+2MiB transparent huge pages.  gg_bench tlb reports dTLB misses for each.
+
+### Interleaved streams
+Each byte's transition depends on the previous one, so a single scan
+is one chain of dependent loads and waits on cache latency.
+With --streams={2,4,8} a large buffer is split into that many segments
+(overlapping by the longest string) whose linked-DFA scans advance in
+lockstep within one thread, so their loads overlap.
+This does not skip; gg_bench streams reports bytes/cycle for each count.
+
+### Tail comparison
 Once subsequent chars must be unique, a memicmp outperforms the FSM.
+When sealed, each linear chain of states ending a string (4 or more bytes)
+is stored as a literal tail and transitions into its first state are
+flagged.  The search compares the whole tail at once (folding case
+16 bytes at a time when caseless) and jumps to its final state;
+on a mismatch the FSM continues one byte at a time.
 
 ### FSM (Finite State Machine)
 Memory is cheap (modern idiom) so
@@ -242,6 +340,38 @@ very sparse tables are generated for
 rapid state transitions.
 Redundancy opportunities are taken by
 re-use of tables with common preceding characters.
+All planes live in one cache-line aligned array indexed
+state*stride+byte with 32-bit state numbers,
+so the count of planes is limited only by memory.
+
+### Compiled images
+Table::dump writes a sealed table as a versioned, checksummed image:
+a header page, then page-aligned planes, terminal groups (s_set, flat),
+tails, inserted strings, accept/reject lists and first letters.
+Table::load maps it read-only and scans the planes in place, rebuilding
+only anchors and engines from the strings (gg_bench image: 20k strings
+compile in about 2s, load in about 10ms).  An image written on a host
+of other byte order, or for other patterns or shape, is refused.
+
+### Query cache
+Patterns are compiled in the ftor, after all arguments are ingested.
+First the query cache (--query-cache={dir}, else $GG_CACHE, else
+$XDG_CACHE_HOME/gg or ~/.cache/gg) is tried: a file named by a hash of
+the accept/reject lists, -c, -v, shape, --budget and the gg version.
+A hit loads the compiled image (above) and skips compiling; a miss
+compiles and stores it.  Files unused for 30 days, and then the least
+recently used beyond 256MiB in all, are removed on each store.
+--no-query-cache bypasses it.  Twelve words with -v levenshtein1 and
+contraction variants take about 110ms to compile and 3ms to load.
+
+### Shared tables
+With --shared, the first gg running a query publishes its image in
+POSIX shared memory (/gg.{uid}.{hash}, readable by its user only) and
+that user's concurrent or later gg map it read-only, so the planes are
+compiled and resident once.  Segments owned by another user are ignored.
+Each user holds a shared flock until it exits; the segment outlives
+its publisher and is removed (by the next publisher) only once no gg
+holds it and none attached for the lease (--shared={seconds}).
 
 ### Memory Mapped files
 No buffering or data copying is required so
@@ -251,8 +381,6 @@ but code simplification merits this choice.
 
 ### TODO
 ```
-// TODO increase permitted count of open files to at least thread count.
-//      currently errno 24 EMFILE occurs frequently
 // TODO embed FSM interpreter to enable specialized programming within C++
 // TODO debug filename regex options.
 // TODO allow recursive web page target in place of directory (no memmap).
@@ -261,13 +389,9 @@ but code simplification merits this choice.
 //      the API exists, but code is undeveloped
 //      Missing: fatfinger, thesaurus, unicode
 // TODO implement m_raw tree as Transition[] and enable search sensitivity to it.
-//      This will enable dump/load to bring in synonym tree.
+//      Table::dump/load can then bring in a synonym tree.
 // TODO measure performance against fgrep/ack/ag
 //      publishing performance will make gg more attractive
-// TODO ingest args with ctor but compile strs at beginning of ftor
-//      compilation in ftor currently fails
-// TODO use memcmp for unique final string
-//      When the tail end of a search is unique memcmp is faster
 // TODO implement self-test (-t)
 //      client-usable as opposed to unit-test and performance test
 // TODO translate UTF8->UnicodeCodepoint->NFKD->UnicodeCodepoint->UTF8
@@ -276,6 +400,11 @@ but code simplification merits this choice.
 //      for instance; convert to Unicode Codepoints, and decompose, then
 //      recompose to canonical NFKD, then reconvert to UTF8, then
 //      strings so recomposed can be compared properly
+// DONE use memcmp for unique final string
+// DONE ingest args with ctor but compile strs at beginning of ftor
+//      patterns are copied before s_target moves on, so views stay valid
+// DONE increase permitted count of open files to at least thread count.
+//      a lock-free descriptor budget replaces errno 24 EMFILE with waiting
 // DONE make targets indirect from search to support multiple matches
 //      currently the target is the direct index into the match array
 // DONE make variant case sensitive locally.
@@ -283,7 +412,7 @@ but code simplification merits this choice.
 // DONE debug fatal error doing ~/bin/gg from ~/Desktop/github
 // DONE variants: acronym, contraction, ellipses, levenshtein1, sensitive
 // DONE multithread: 1 manager, N-1 workers where N=cpu count
-// DONE oversize multiplier on cpu count yields no speed advantage
+// DONE oversize multiplier applies to I/O threads, not scan threads
 // DONE enable choice between state planes of size 16 and 256.
 ```
 
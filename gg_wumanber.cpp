@@ -0,0 +1,102 @@
+/*_____________________________________________________________________________
+            The MIT License (https://opensource.org/licenses/MIT)
+
+        Copyright (c) 2017, Jonathan D. Lettvin, All Rights Reserved.
+
+Permission is hereby granted, free of charge, to any person obtaining a copy of
+this software and associated documentation files (the "Software"), to deal in
+the Software without restriction, including without limitation the rights to
+use, copy, modify, merge, publish, distribute, sublicense, and/or sell copies
+of the Software, and to permit persons to whom the Software is furnished to do
+so, subject to the following conditions:
+
+The above copyright notice and this permission notice shall be included in all
+copies or substantial portions of the Software.
+
+THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+SOFTWARE.
+_____________________________________________________________________________*/
+
+#include <cctype>
+
+#include "gg_wumanber.h"
+
+namespace
+{
+	std::array<uint8_t, 256>
+	folding ()
+	{
+		std::array<uint8_t, 256> fold;
+		for (size_t byte=0; byte < 256; ++byte)
+		{
+			fold[byte] = static_cast<uint8_t> (
+					byte >= 'A' && byte <= 'Z' ? byte | 0x20 : byte);
+		}
+		return fold;
+	}
+}
+
+const std::array<uint8_t, 256> Lettvin::WuManber::s_fold{folding ()};
+
+//------------------------------------------------------------------------------
+/// @brief add a string ending in group a_grp
+void
+Lettvin::WuManber::
+insert (string_view a_str, bool a_caseless, i24_t a_grp)
+//------------------------------------------------------------------------------
+{
+	String str;
+	str.m_literal  = a_str;
+	str.m_caseless = a_caseless;
+	str.m_grp      = a_grp;
+	if (a_caseless)
+	{
+		for (auto& c:str.m_literal) c = static_cast<char> (s_fold[uint8_t (c)]);
+	}
+	m_min = min (m_min, str.m_literal.size ());
+	m_strings.emplace_back (str);
+} // insert
+
+//------------------------------------------------------------------------------
+/// @brief build the shift and bucket tables after all inserts
+///
+/// B is 3 from 256 strings of 5 or more bytes (so fewer blocks have
+/// shift 0; see gg_bench manber), otherwise 2.  Each string's first m bytes contribute every block:
+/// the block ending at offset q allows a shift of m-1-q.
+void
+Lettvin::WuManber::
+prepare ()
+//------------------------------------------------------------------------------
+{
+	m_block = (m_strings.size () >= 256 && m_min >= 5) ? 3 : 2;
+	size_t hashes{size_t (1) << (m_block == 2 ? 16 : 18)};
+	size_t most{m_min - m_block + 1};
+	m_shift.assign (hashes, static_cast<uint8_t> (min (most, size_t (0xff))));
+	vector<vector<uint32_t>> buckets (hashes);
+	for (size_t index=0; index < m_strings.size (); ++index)
+	{
+		auto& str{m_strings[index]};
+		const uint8_t* bytes{reinterpret_cast<const uint8_t*> (str.m_literal.data ())};
+		str.m_prefix = key (bytes);
+		for (size_t q=m_block - 1; q < m_min; ++q)
+		{
+			size_t h{hash (bytes + q + 1 - m_block)};
+			m_shift[h] = static_cast<uint8_t> (
+					min (size_t (m_shift[h]), m_min - 1 - q));
+		}
+		buckets[hash (bytes + m_min - m_block)].push_back (index);
+	}
+	m_bucket.assign (hashes + 1, 0);
+	m_list.clear ();
+	for (size_t h=0; h < hashes; ++h)
+	{
+		m_bucket[h] = m_list.size ();
+		m_list.insert (m_list.end (), buckets[h].begin (), buckets[h].end ());
+	}
+	m_bucket[hashes] = m_list.size ();
+} // prepare
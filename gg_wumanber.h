@@ -0,0 +1,150 @@
+/*_____________________________________________________________________________
+            The MIT License (https://opensource.org/licenses/MIT)
+
+        Copyright (c) 2017, Jonathan D. Lettvin, All Rights Reserved.
+
+Permission is hereby granted, free of charge, to any person obtaining a copy of
+this software and associated documentation files (the "Software"), to deal in
+the Software without restriction, including without limitation the rights to
+use, copy, modify, merge, publish, distribute, sublicense, and/or sell copies
+of the Software, and to permit persons to whom the Software is furnished to do
+so, subject to the following conditions:
+
+The above copyright notice and this permission notice shall be included in all
+copies or substantial portions of the Software.
+
+THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+SOFTWARE.
+_____________________________________________________________________________*/
+
+#pragma once
+
+#include <array>
+#include <cstdint>
+#include <string>
+#include <vector>
+#include <atomic>
+#include <string_view>
+
+#include "gg_globals.h"
+#include "gg_anchor.h"             // Anchors::equal
+
+namespace Lettvin
+{
+	using namespace std;
+
+	//CCCCCCCCCCCCCCCCCCCCCCCCCCCCCCCCCCCCCCCCCCCCCCCCCCCCCCCCCCCCCCCCCCCCCCCCCC
+	/// @brief Wu-Manber block-shift matcher for many strings
+	///
+	/// A window of the shortest string length m slides over the text.
+	/// The last B (2 or 3) bytes of the window index a shift table: how far
+	/// the window may move before those bytes could end a string's first m
+	/// bytes.  A zero shift selects a bucket of strings to verify at the
+	/// window start; a 2-byte prefix check discards most before comparing.
+	/// Blocks are hashed case-folded so caseless strings share the tables;
+	/// verification is exact (or caseless) per string.
+	//__________________________________________________________________________
+	class
+	WuManber
+	{
+	//------
+	public:
+	//------
+		//----------------------------------------------------------------------
+		/// @brief add a string ending in group a_grp
+		void insert (string_view a_str, bool a_caseless, i24_t a_grp);
+
+		//----------------------------------------------------------------------
+		/// @brief build the shift and bucket tables after all inserts
+		void prepare ();
+
+		//----------------------------------------------------------------------
+		size_t shortest () const { return m_min; }
+		size_t count    () const { return m_strings.size (); }
+
+		//----------------------------------------------------------------------
+		/// @brief call a_found (grp) for strings starting in [0, a_anchors)
+		///
+		/// a_found returns true to stop (rejection or completion).
+		template<typename F>
+		void scan (
+				const char*         a_begin,
+				size_t              a_anchors,
+				size_t              a_count,
+				F                   a_found,
+				const atomic<bool>* a_cancel) const
+		{
+			const uint8_t* text{reinterpret_cast<const uint8_t*> (a_begin)};
+			size_t end{min (a_count, a_anchors + m_min - 1)};
+			size_t check{0};
+			for (size_t pos=m_min - 1; pos < end;)
+			{
+				if (++check == 1 << 14)
+				{
+					check = 0;
+					if (a_cancel && a_cancel->load (std::memory_order_relaxed)) return;
+				}
+				size_t block{hash (text + pos + 1 - m_block)};
+				if (size_t shift = m_shift[block])
+				{
+					pos += shift;
+					continue;
+				}
+				size_t start{pos + 1 - m_min};
+				uint16_t prefix{key (text + start)};
+				for (uint32_t b=m_bucket[block], B=m_bucket[block + 1]; b < B; ++b)
+				{
+					const String& str{m_strings[m_list[b]]};
+					if (str.m_prefix != prefix) continue;
+					if (start + str.m_literal.size () > a_count) continue;
+					if (!Anchors::equal (a_begin + start, str.m_literal.data (),
+								str.m_literal.size (), str.m_caseless)) continue;
+					if (a_found (str.m_grp)) return;
+				}
+				++pos;
+			}
+		}
+
+	//------
+	private:
+	//------
+		//----------------------------------------------------------------------
+		/// @brief case-folded hash of the B bytes at a_at
+		size_t hash (const uint8_t* a_at) const
+		{
+			if (m_block == 2) return (s_fold[a_at[0]] << 8) | s_fold[a_at[1]];
+			return ((s_fold[a_at[0]] << 12) ^ (s_fold[a_at[1]] << 6)
+					^ s_fold[a_at[2]]) & 0x3ffff;
+		}
+
+		//----------------------------------------------------------------------
+		/// @brief case-folded first two bytes
+		static uint16_t key (const uint8_t* a_at)
+		{
+			return static_cast<uint16_t> ((s_fold[a_at[0]] << 8) | s_fold[a_at[1]]);
+		}
+
+		//----------------------------------------------------------------------
+		struct String
+		{
+			string   m_literal;            ///< lower case when caseless
+			bool     m_caseless{false};
+			i24_t    m_grp     {0};
+			uint16_t m_prefix  {0};        ///< key of first two bytes
+		};
+
+		static const array<uint8_t, 256> s_fold;   ///< ASCII lower case
+
+		vector<String>   m_strings;
+		size_t           m_min  {~size_t (0)};     ///< shortest string
+		size_t           m_block{2};               ///< bytes per block
+		vector<uint8_t>  m_shift;                  ///< by block hash
+		vector<uint32_t> m_bucket;                 ///< CSR offsets by hash
+		vector<uint32_t> m_list;                   ///< string indices
+	}; // class WuManber
+} // namespace Lettvin